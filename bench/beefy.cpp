@@ -0,0 +1,316 @@
+/** @file beefy.cpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  beefy::allocator against malloc and the std::pmr resources on
+ *         the usual allocation patterns:
+ *         - ping-pong -- a block is allocated and freed right away
+ *         - LIFO and FIFO churn -- a round of blocks is allocated, then
+ *           freed in the reverse or in the same order
+ *         - random size mix -- random sizes, freed in a random order
+ *         - fill to exhaustion -- a whole storage is taken, then given back
+ *         - batches -- allocate_n/deallocate_n against the same number of
+ *           single allocate/deallocate calls
+ *
+ *         Every benchmark iteration is a round of allocations, the items
+ *         per second are allocations. monotonic_buffer_resource never
+ *         gives memory back, it is released after every round.
+ *
+ *         JSON for the regression tracking:
+ *         bench --benchmark_format=json (or the 'bench-json' target)
+ */
+
+#include "allocators/beefy.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace kcppt;
+using namespace kcppt::allocators;
+
+constexpr auto round_size = std::size_t(256u);
+constexpr auto max_size = std::size_t(512u);
+constexpr auto fill_size = std::size_t(64u);
+constexpr auto fill_count = std::size_t(4096u);
+
+beefy::storage<char,  16, 4096> s16;
+beefy::storage<char,  32, 4096> s32;
+beefy::storage<char,  64, fill_count> s64;
+beefy::storage<char, 128, 4096> s128;
+beefy::storage<char, 256, 4096> s256;
+beefy::storage<char, max_size, 4096> s512;
+
+auto storages = beefy::make_ptrs_to_storages_array<char>(
+    s16, s32, s64, s128, s256, s512
+);
+
+/**
+ * @brief The allocators under test behind the same interface
+ */
+struct with_beefy {
+    beefy::allocator<char, decltype(storages), storages> a;
+    
+    auto allocate (std::size_t n) noexcept -> void* {
+        return a.allocate(n);
+    }
+    
+    auto deallocate (void* p, std::size_t n) noexcept -> void {
+        a.deallocate(static_cast<char*>(p), n);
+    }
+    
+    auto end_round () noexcept -> void {}
+};
+
+struct with_malloc {
+    auto allocate (std::size_t n) noexcept -> void* {
+        return std::malloc(n);
+    }
+    
+    auto deallocate (void* p, std::size_t) noexcept -> void {
+        std::free(p);
+    }
+    
+    auto end_round () noexcept -> void {}
+};
+
+struct with_pool {
+    std::pmr::unsynchronized_pool_resource r;
+    
+    auto allocate (std::size_t n) -> void* {
+        return r.allocate(n);
+    }
+    
+    auto deallocate (void* p, std::size_t n) -> void {
+        r.deallocate(p, n);
+    }
+    
+    auto end_round () noexcept -> void {}
+};
+
+struct with_monotonic {
+    std::vector<std::byte> buffer = std::vector<std::byte>(1u << 20u);
+    std::pmr::monotonic_buffer_resource r {buffer.data(), buffer.size()};
+    
+    auto allocate (std::size_t n) -> void* {
+        return r.allocate(n);
+    }
+    
+    auto deallocate (void* p, std::size_t n) -> void {
+        r.deallocate(p, n);
+    }
+    
+    auto end_round () -> void {
+        r.release();
+    }
+};
+
+template <typename A>
+auto ping_pong (benchmark::State& state) -> void {
+    auto a = A();
+    auto n = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        for (auto k : range::range(round_size)) {
+            (void)k;
+            auto p = a.allocate(n);
+            benchmark::DoNotOptimize(p);
+            a.deallocate(p, n);
+        }
+        a.end_round();
+    }
+    state.SetItemsProcessed(state.iterations() * round_size);
+}
+
+template <typename A>
+auto lifo_churn (benchmark::State& state) -> void {
+    auto a = A();
+    auto n = static_cast<std::size_t>(state.range(0));
+    std::array<void*, round_size> ps {};
+    for (auto _ : state) {
+        for (auto& p : ps) {
+            p = a.allocate(n);
+        }
+        benchmark::DoNotOptimize(ps.data());
+        for (auto k = round_size; k != 0u; --k) {
+            a.deallocate(ps[k - 1u], n);
+        }
+        a.end_round();
+    }
+    state.SetItemsProcessed(state.iterations() * round_size);
+}
+
+template <typename A>
+auto fifo_churn (benchmark::State& state) -> void {
+    auto a = A();
+    auto n = static_cast<std::size_t>(state.range(0));
+    std::array<void*, round_size> ps {};
+    for (auto _ : state) {
+        for (auto& p : ps) {
+            p = a.allocate(n);
+        }
+        benchmark::DoNotOptimize(ps.data());
+        for (auto p : ps) {
+            a.deallocate(p, n);
+        }
+        a.end_round();
+    }
+    state.SetItemsProcessed(state.iterations() * round_size);
+}
+
+/**
+ * @brief Sizes from 1 to max_size and the order to free them in, the same
+ *        for every allocator
+ */
+struct random_round {
+    std::array<std::size_t, round_size> sizes;
+    std::array<std::size_t, round_size> order;
+    
+    random_round () {
+        auto gen = std::mt19937(42u);
+        auto dist = std::uniform_int_distribution<std::size_t>(1u, max_size);
+        for (auto& s : sizes) {
+            s = dist(gen);
+        }
+        std::iota(order.begin(), order.end(), std::size_t(0u));
+        std::shuffle(order.begin(), order.end(), gen);
+    }
+};
+
+template <typename A>
+auto random_mix (benchmark::State& state) -> void {
+    auto a = A();
+    const auto r = random_round();
+    std::array<void*, round_size> ps {};
+    for (auto _ : state) {
+        for (auto k : range::indices(ps)) {
+            ps[k] = a.allocate(r.sizes[k]);
+        }
+        benchmark::DoNotOptimize(ps.data());
+        for (auto k : r.order) {
+            a.deallocate(ps[k], r.sizes[k]);
+        }
+        a.end_round();
+    }
+    state.SetItemsProcessed(state.iterations() * round_size);
+}
+
+/**
+ * @brief Allocate until beefy's storage runs out (one failed allocation),
+ *        the others take as many blocks plus one
+ */
+template <typename A>
+auto fill_to_exhaustion (benchmark::State& state) -> void {
+    auto a = A();
+    auto ps = std::vector<void*>(fill_count + 1u);
+    auto total = std::size_t(0u);
+    for (auto _ : state) {
+        auto n = std::size_t(0u);
+        while (n != ps.size()) {
+            auto p = a.allocate(fill_size);
+            if (p == nullptr) {
+                break;
+            }
+            ps[n++] = p;
+        }
+        benchmark::DoNotOptimize(ps.data());
+        for (auto k : range::range(n)) {
+            a.deallocate(ps[k], fill_size);
+        }
+        a.end_round();
+        total += n;
+    }
+    state.SetItemsProcessed(total);
+}
+
+/**
+ * @brief 'count' same-size blocks of beefy, one by one or in a single call
+ */
+auto beefy_single_loop (benchmark::State& state) -> void {
+    auto a = with_beefy();
+    auto count = static_cast<std::size_t>(state.range(0));
+    auto ps = std::vector<char*>(count);
+    for (auto _ : state) {
+        for (auto& p : ps) {
+            p = a.a.allocate(fill_size);
+        }
+        benchmark::DoNotOptimize(ps.data());
+        for (auto p : ps) {
+            a.a.deallocate(p, fill_size);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+auto beefy_batch (benchmark::State& state) -> void {
+    auto a = with_beefy();
+    auto count = static_cast<std::size_t>(state.range(0));
+    auto ps = std::vector<char*>(count);
+    for (auto _ : state) {
+        auto n = a.a.allocate_n(fill_size, count, ps.data());
+        benchmark::DoNotOptimize(ps.data());
+        a.a.deallocate_n(ps.data(), n, fill_size);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+}
+
+BENCHMARK_TEMPLATE(ping_pong, with_beefy)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(ping_pong, with_malloc)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(ping_pong, with_pool)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(ping_pong, with_monotonic)->Arg(16)->Arg(64)->Arg(512);
+
+BENCHMARK_TEMPLATE(lifo_churn, with_beefy)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(lifo_churn, with_malloc)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(lifo_churn, with_pool)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(lifo_churn, with_monotonic)->Arg(16)->Arg(64)->Arg(512);
+
+BENCHMARK_TEMPLATE(fifo_churn, with_beefy)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(fifo_churn, with_malloc)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(fifo_churn, with_pool)->Arg(16)->Arg(64)->Arg(512);
+BENCHMARK_TEMPLATE(fifo_churn, with_monotonic)->Arg(16)->Arg(64)->Arg(512);
+
+BENCHMARK_TEMPLATE(random_mix, with_beefy);
+BENCHMARK_TEMPLATE(random_mix, with_malloc);
+BENCHMARK_TEMPLATE(random_mix, with_pool);
+BENCHMARK_TEMPLATE(random_mix, with_monotonic);
+
+BENCHMARK_TEMPLATE(fill_to_exhaustion, with_beefy);
+BENCHMARK_TEMPLATE(fill_to_exhaustion, with_malloc);
+BENCHMARK_TEMPLATE(fill_to_exhaustion, with_pool);
+BENCHMARK_TEMPLATE(fill_to_exhaustion, with_monotonic);
+
+BENCHMARK(beefy_single_loop)->Arg(8)->Arg(32)->Arg(128);
+BENCHMARK(beefy_batch)->Arg(8)->Arg(32)->Arg(128);
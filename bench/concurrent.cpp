@@ -0,0 +1,127 @@
+/** @file concurrent.cpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Throughput of beefy::concurrent_allocator against the number of
+ *         threads, next to a beefy::allocator behind a single mutex and
+ *         malloc.
+ *
+ *         Every thread allocates a round of blocks and frees them, the
+ *         items per second (real time) are allocations of all the threads
+ *         together, so they should grow with the threads up to the number
+ *         of cores.
+ */
+
+#include "allocators/beefy/concurrent.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+
+using namespace kcppt;
+using namespace kcppt::allocators;
+
+constexpr auto round_size = std::size_t(64u);
+constexpr auto block_size = std::size_t(64u);
+
+/**
+ * @brief Enough blocks for 16 threads with full rounds and magazines
+ */
+beefy::storage<char, 16, 4096> s16;
+beefy::bitmap_storage<char, block_size, 4096> s64;
+beefy::storage<char, 256, 4096> s256;
+
+auto storages = beefy::make_ptrs_to_storages_array<char>(s16, s64, s256);
+
+struct with_concurrent {
+    beefy::concurrent_allocator<char, decltype(storages), storages> a;
+    
+    auto allocate (std::size_t n) noexcept -> void* {
+        return a.allocate(n);
+    }
+    
+    auto deallocate (void* p, std::size_t n) noexcept -> void {
+        a.deallocate(static_cast<char*>(p), n);
+    }
+};
+
+/**
+ * @brief What the concurrent allocator replaces, every call takes the lock
+ */
+struct with_locked {
+    inline static std::mutex lock;
+    beefy::allocator<char, decltype(storages), storages> a;
+    
+    auto allocate (std::size_t n) noexcept -> void* {
+        std::lock_guard<std::mutex> guard(lock);
+        return a.allocate(n);
+    }
+    
+    auto deallocate (void* p, std::size_t n) noexcept -> void {
+        std::lock_guard<std::mutex> guard(lock);
+        a.deallocate(static_cast<char*>(p), n);
+    }
+};
+
+struct with_malloc {
+    auto allocate (std::size_t n) noexcept -> void* {
+        return std::malloc(n);
+    }
+    
+    auto deallocate (void* p, std::size_t) noexcept -> void {
+        std::free(p);
+    }
+};
+
+template <typename A>
+auto threaded_churn (benchmark::State& state) -> void {
+    auto a = A();
+    std::array<void*, round_size> ps {};
+    for (auto _ : state) {
+        for (auto& p : ps) {
+            p = a.allocate(block_size);
+        }
+        benchmark::DoNotOptimize(ps.data());
+        for (auto p : ps) {
+            a.deallocate(p, block_size);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * round_size);
+}
+
+}
+
+BENCHMARK_TEMPLATE(threaded_churn, with_concurrent)
+    ->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(threaded_churn, with_locked)
+    ->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(threaded_churn, with_malloc)
+    ->ThreadRange(1, 16)->UseRealTime();
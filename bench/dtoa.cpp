@@ -0,0 +1,170 @@
+/** @file dtoa.cpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  iofmt float formatting against snprintf and std::to_chars:
+ *         - shortest -- dtoa::to_shortest, to_chars with no precision and
+ *           snprintf "%.17g" (the shortest digits libc can round-trip with)
+ *         - fixed -- dtoa::to_fixed, to_chars and snprintf with "%.3f"
+ *
+ *         Values are 1024 doubles of random bits (any exponent) or
+ *         'sensor readings' in [0, 1000) with a few decimals, chosen by the
+ *         argument (0 or 1). Items per second are formatted values.
+ */
+
+#include "iofmt/common/dtoa.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+using namespace kcppt::iofmt::common;
+
+constexpr auto values_count = std::size_t(1024u);
+constexpr auto precision = 3;
+
+using values_t = std::array<double, values_count>;
+
+auto make_values (std::int64_t kind) -> values_t {
+    auto gen = std::mt19937_64(42u);
+    values_t vs {};
+    for (auto& v : vs) {
+        if (kind == 0) {
+            do {
+                auto bits = gen();
+                std::memcpy(&v, &bits, sizeof(v));
+            } while (!std::isfinite(v));
+        } else {
+            v = double(gen() % 1000000u) / 1000.0;
+        }
+    }
+    return vs;
+}
+
+/**
+ * @brief Room for any "%.3f" of a double, 309 digits and the fraction
+ */
+using buffer_t = std::array<char, 512u>;
+
+auto shortest_dtoa (benchmark::State& state) -> void {
+    auto vs = make_values(state.range(0));
+    buffer_t buf {};
+    for (auto _ : state) {
+        for (auto v : vs) {
+            auto e = dtoa::to_shortest(buf.data(), v);
+            benchmark::DoNotOptimize(e);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * values_count);
+}
+
+auto shortest_to_chars (benchmark::State& state) -> void {
+    auto vs = make_values(state.range(0));
+    buffer_t buf {};
+    for (auto _ : state) {
+        for (auto v : vs) {
+            auto r = std::to_chars(buf.data(), buf.data() + buf.size(), v);
+            benchmark::DoNotOptimize(r.ptr);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * values_count);
+}
+
+auto shortest_snprintf (benchmark::State& state) -> void {
+    auto vs = make_values(state.range(0));
+    buffer_t buf {};
+    for (auto _ : state) {
+        for (auto v : vs) {
+            auto n = std::snprintf(buf.data(), buf.size(), "%.17g", v);
+            benchmark::DoNotOptimize(n);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * values_count);
+}
+
+auto fixed_dtoa (benchmark::State& state) -> void {
+    auto vs = make_values(state.range(0));
+    buffer_t buf {};
+    for (auto _ : state) {
+        for (auto v : vs) {
+            auto p = buf.data();
+            dtoa::to_fixed(
+                [&p](const char* s, std::size_t n) {
+                    std::memcpy(p, s, n);
+                    p += n;
+                },
+                v, precision, false
+            );
+            benchmark::DoNotOptimize(p);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * values_count);
+}
+
+auto fixed_to_chars (benchmark::State& state) -> void {
+    auto vs = make_values(state.range(0));
+    buffer_t buf {};
+    for (auto _ : state) {
+        for (auto v : vs) {
+            auto r = std::to_chars(
+                buf.data(), buf.data() + buf.size(), v,
+                std::chars_format::fixed, precision
+            );
+            benchmark::DoNotOptimize(r.ptr);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * values_count);
+}
+
+auto fixed_snprintf (benchmark::State& state) -> void {
+    auto vs = make_values(state.range(0));
+    buffer_t buf {};
+    for (auto _ : state) {
+        for (auto v : vs) {
+            auto n = std::snprintf(buf.data(), buf.size(), "%.3f", v);
+            benchmark::DoNotOptimize(n);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * values_count);
+}
+
+}
+
+BENCHMARK(shortest_dtoa)->Arg(0)->Arg(1);
+BENCHMARK(shortest_to_chars)->Arg(0)->Arg(1);
+BENCHMARK(shortest_snprintf)->Arg(0)->Arg(1);
+
+BENCHMARK(fixed_dtoa)->Arg(0)->Arg(1);
+BENCHMARK(fixed_to_chars)->Arg(0)->Arg(1);
+BENCHMARK(fixed_snprintf)->Arg(0)->Arg(1);
@@ -0,0 +1,237 @@
+/** @file layout.cpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Control data layout of beefy::storage: the packed heap nodes
+ *         (flag and index in one word of the least fitting width, cache line
+ *         aligned) against the former layout of three separate arrays
+ *         (bool flags, size_t indices and reversed indices), kept here as
+ *         'split_storage'.
+ *
+ *         Both are run on 2^12, 2^16 and 2^20 blocks:
+ *         - churn -- the pool is full, a random block is freed and the top
+ *           block taken again, so every operation walks the heap from a
+ *           random node to the top and back down
+ *         - fill and drain -- the whole pool is taken, then freed in
+ *           a random order
+ */
+
+#include "allocators/beefy.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace kcppt;
+using namespace kcppt::allocators;
+
+constexpr auto block_size = std::size_t(8u);
+
+/**
+ * @brief beefy::storage as it was before the packed nodes, without the
+ *        storage_base interface and the hardened mode
+ */
+template <typename T, std::size_t TBlockSize, std::size_t TBlocksCount>
+class split_storage {
+private:
+    T _pool_of_T[TBlockSize * TBlocksCount];
+    std::array<bool, TBlocksCount> _heap_flags;
+    std::array<std::size_t, TBlocksCount> _heap_indices;
+    std::array<std::size_t, TBlocksCount> _heap_indices_reversed;
+
+public:
+    split_storage () noexcept :
+        _pool_of_T(),
+        _heap_flags(),
+        _heap_indices(
+            beefy::_implementation::build_indices_array<TBlocksCount>()
+        ),
+        _heap_indices_reversed(
+            beefy::_implementation::build_indices_array<TBlocksCount>()
+        )
+    {}
+
+public:
+    [[nodiscard]]
+    auto allocate_block () noexcept -> T* {
+        if (_heap_flags[0u]) {
+            return nullptr;
+        }
+        auto p = _pool_of_T + _heap_indices[0u] * TBlockSize;
+        _heap_flags[0u] = true;
+        _heap_el_sink(0u);
+        return p;
+    }
+    
+    auto deallocate_block (T* p) noexcept -> void {
+        auto ip = beefy::_implementation::pool_index(
+            _pool_of_T, TBlockSize, TBlocksCount, p
+        );
+        if (ip >= TBlocksCount) {
+            return;
+        }
+        auto iheap = _heap_indices_reversed[ip];
+        _heap_flags[iheap] = false;
+        _heap_el_float(iheap);
+    }
+
+private:
+    auto _heap_swap (std::size_t i0, std::size_t i1) noexcept -> void {
+        auto ri0 = _heap_indices[i0];
+        auto ri1 = _heap_indices[i1];
+        std::swap(_heap_flags[i0], _heap_flags[i1]);
+        std::swap(_heap_indices[i0], _heap_indices[i1]);
+        std::swap(_heap_indices_reversed[ri0], _heap_indices_reversed[ri1]);
+    }
+    
+    [[nodiscard]]
+    auto _heap_build_triple (std::size_t i) noexcept -> std::size_t {
+        auto ret = i;
+        auto il = 2 * i + 1u;
+        if (il >= TBlocksCount) {
+            return ret;
+        }
+        if (_heap_flags[i] > _heap_flags[il]) {
+            _heap_swap(i, il);
+            ret = il;
+        }
+        auto ir = 2 * i + 2u;
+        if (ir >= TBlocksCount) {
+            return ret;
+        }
+        if (_heap_flags[i] > _heap_flags[ir]) {
+            _heap_swap(i, ir);
+            ret = (ret == il) ? il : ir;
+        }
+        return ret;
+    }
+    
+    auto _heap_el_sink (std::size_t i) noexcept -> void {
+        while (true) {
+            auto child = _heap_build_triple(i);
+            if (child == i) {
+                break;
+            }
+            i = child;
+        }
+    }
+    
+    auto _heap_el_float (std::size_t i) noexcept -> void {
+        while (i != 0u) {
+            auto i_even = ((i & 0b1u) == 0u);
+            auto ip = i / 2u - i_even;
+            if (_heap_flags[ip] > _heap_flags[i]) {
+                _heap_swap(ip, i);
+                i = ip;
+            } else {
+                break;
+            }
+        }
+    }
+};
+
+template <std::size_t N>
+using packed = beefy::storage<char, block_size, N>;
+
+template <std::size_t N>
+using split = split_storage<char, block_size, N>;
+
+/**
+ * @brief A random order of all the blocks, the same for both layouts
+ */
+auto random_order (std::size_t n) -> std::vector<std::size_t> {
+    auto order = std::vector<std::size_t>(n);
+    std::iota(order.begin(), order.end(), std::size_t(0u));
+    std::shuffle(order.begin(), order.end(), std::mt19937(42u));
+    return order;
+}
+
+template <typename S>
+auto layout_churn (benchmark::State& state) -> void {
+    /// too large for the stack
+    auto s = std::make_unique<S>();
+    auto ps = std::vector<char*>();
+    for (auto p = s->allocate_block(); p != nullptr; p = s->allocate_block()) {
+        ps.push_back(p);
+    }
+    auto order = random_order(ps.size());
+    auto k = std::size_t(0u);
+    for (auto _ : state) {
+        auto i = order[k];
+        k = (k + 1u == order.size()) ? 0u : k + 1u;
+        s->deallocate_block(ps[i]);
+        ps[i] = s->allocate_block();
+        benchmark::DoNotOptimize(ps[i]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename S>
+auto layout_fill_and_drain (benchmark::State& state) -> void {
+    auto s = std::make_unique<S>();
+    auto ps = std::vector<char*>();
+    for (auto p = s->allocate_block(); p != nullptr; p = s->allocate_block()) {
+        ps.push_back(p);
+    }
+    auto order = random_order(ps.size());
+    for (auto i : order) {
+        s->deallocate_block(ps[i]);
+    }
+    for (auto _ : state) {
+        for (auto& p : ps) {
+            p = s->allocate_block();
+        }
+        benchmark::DoNotOptimize(ps.data());
+        for (auto i : order) {
+            s->deallocate_block(ps[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * ps.size());
+}
+
+}
+
+BENCHMARK_TEMPLATE(layout_churn, packed<(1u << 12u)>);
+BENCHMARK_TEMPLATE(layout_churn, split<(1u << 12u)>);
+BENCHMARK_TEMPLATE(layout_churn, packed<(1u << 16u)>);
+BENCHMARK_TEMPLATE(layout_churn, split<(1u << 16u)>);
+BENCHMARK_TEMPLATE(layout_churn, packed<(1u << 20u)>);
+BENCHMARK_TEMPLATE(layout_churn, split<(1u << 20u)>);
+
+BENCHMARK_TEMPLATE(layout_fill_and_drain, packed<(1u << 12u)>);
+BENCHMARK_TEMPLATE(layout_fill_and_drain, split<(1u << 12u)>);
+BENCHMARK_TEMPLATE(layout_fill_and_drain, packed<(1u << 16u)>);
+BENCHMARK_TEMPLATE(layout_fill_and_drain, split<(1u << 16u)>);
+BENCHMARK_TEMPLATE(layout_fill_and_drain, packed<(1u << 20u)>);
+BENCHMARK_TEMPLATE(layout_fill_and_drain, split<(1u << 20u)>);
@@ -0,0 +1,156 @@
+/** @file lockfree.cpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Stress test of beefy::lockfree_storage, hammered from many threads.
+ *
+ *         Every thread allocates blocks and swaps them into random slots of
+ *         a shared table, whatever it gets back (allocated by some other
+ *         thread) it frees. So blocks are allocated and freed by different
+ *         threads all the time.
+ *         A block is a counter of its owners, it must be 0 when the block is
+ *         handed out and 1 when it is freed, otherwise two threads got the
+ *         same block. When every thread is done the whole pool must be free
+ *         again, with every block exactly once.
+ *
+ *         Violations abort, so the test fails under ctest as well.
+ */
+
+#include "allocators/beefy/lockfree.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using namespace kcppt;
+using namespace kcppt::allocators;
+
+using owners_t = std::atomic<std::uint32_t>;
+
+constexpr auto blocks_count = std::size_t(1024u);
+constexpr auto slots_count = std::size_t(64u);
+
+beefy::lockfree_storage<owners_t, 1, blocks_count> pool;
+
+std::array<std::atomic<owners_t*>, slots_count> slots {};
+
+auto check (bool ok, const char* what) -> void {
+    if (!ok) {
+        std::fprintf(stderr, "lockfree stress: %s\n", what);
+        std::abort();
+    }
+}
+
+auto take () -> owners_t* {
+    auto p = pool.allocate_block();
+    if (p != nullptr) {
+        check(p->fetch_add(1u) == 0u, "a block was handed out twice");
+    }
+    return p;
+}
+
+auto give (owners_t* p) -> void {
+    if (p != nullptr) {
+        check(p->fetch_sub(1u) == 1u, "a block was freed by a non-owner");
+        pool.deallocate_block(p);
+    }
+}
+
+/**
+ * @brief Run by a single thread when all the others are done
+ */
+auto check_pool_is_free () -> void {
+    for (auto& s : slots) {
+        give(s.exchange(nullptr));
+    }
+    auto ps = std::vector<owners_t*>(blocks_count + 1u);
+    auto n = pool.allocate_blocks(ps.data(), ps.size());
+    check(n == blocks_count, "blocks are lost");
+    std::sort(ps.begin(), ps.begin() + n);
+    check(
+        std::adjacent_find(ps.begin(), ps.begin() + n) == ps.begin() + n,
+        "a block is free twice"
+    );
+    pool.deallocate_blocks(ps.data(), n);
+    
+    /// a double free must not make a block come out twice
+    auto p = pool.allocate_block();
+    pool.deallocate_block(p);
+    pool.deallocate_block(p);
+    auto p0 = pool.allocate_block();
+    auto p1 = pool.allocate_block();
+    check(p0 != p1, "a double freed block is handed out twice");
+    pool.deallocate_block(p0);
+    pool.deallocate_block(p1);
+}
+
+auto lockfree_stress (benchmark::State& state) -> void {
+    auto seed = std::uint32_t(state.thread_index() + 1u) * 2654435761u;
+    for (auto _ : state) {
+        seed = seed * 1664525u + 1013904223u;
+        auto s = (seed >> 16u) % slots_count;
+        give(slots[s].exchange(take()));
+    }
+    if (state.thread_index() == 0) {
+        check_pool_is_free();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Same, but the blocks are taken and given in batches
+ */
+auto lockfree_stress_batch (benchmark::State& state) -> void {
+    constexpr auto batch = std::size_t(8u);
+    std::array<owners_t*, batch> ps {};
+    for (auto _ : state) {
+        auto n = pool.allocate_blocks(ps.data(), batch);
+        for (auto k : range::range(n)) {
+            check(ps[k]->fetch_add(1u) == 0u, "a block was handed out twice");
+        }
+        for (auto k : range::range(n)) {
+            check(ps[k]->fetch_sub(1u) == 1u, "a block was freed twice");
+        }
+        pool.deallocate_blocks(ps.data(), n);
+    }
+    if (state.thread_index() == 0) {
+        check_pool_is_free();
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+}
+
+BENCHMARK(lockfree_stress)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(lockfree_stress_batch)->ThreadRange(1, 16)->UseRealTime();
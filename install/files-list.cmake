@@ -23,12 +23,23 @@
 set(
     headers-list-template
     
+    PREFIX_DIR/allocators/arena.hpp
     PREFIX_DIR/allocators/beefy.hpp
+    PREFIX_DIR/allocators/beefy/concurrent.hpp
+    PREFIX_DIR/allocators/beefy/lockfree.hpp
+    PREFIX_DIR/allocators/beefy/mapped_storage.hpp
+    PREFIX_DIR/allocators/beefy/numa.hpp
+    PREFIX_DIR/allocators/beefy/pmr.hpp
+    PREFIX_DIR/allocators/beefy/size_classes.hpp
+    PREFIX_DIR/allocators/buddy.hpp
+    PREFIX_DIR/allocators/slab.hpp
 
     PREFIX_DIR/io/common/builtin.hpp
     PREFIX_DIR/io/common/conversion.hpp
     PREFIX_DIR/io/common/conversion_table.hpp
+    PREFIX_DIR/io/common/dtoa.hpp
     PREFIX_DIR/io/common/fmt.hpp
+    PREFIX_DIR/io/common/sink.hpp
     
     PREFIX_DIR/io/printf/str_and_int.hpp
     PREFIX_DIR/io/out_str_and_int.hpp
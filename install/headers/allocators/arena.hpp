@@ -0,0 +1,367 @@
+/** @file arena.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Fixed-capacity bump arena: allocation moves a single offset,
+ *         memory is given back all at once by rewinding to a marker.
+ *
+ * @details
+ *
+ *        There is no bookkeeping per allocation at all, an allocation is
+ *        an alignment and a bounds check. Individual deallocation is not
+ *        supported, instead:
+ *        - mark() remembers the current state, rewind(marker) frees
+ *          everything allocated after the marker. Markers nest like a stack.
+ *        - 'scope' does the same on its construction and destruction
+ *        - reset() frees everything
+ *
+ *        When the arena is full, requests can go to a fallback allocator
+ *        (e.g. beefy allocator or direct_allocator of a byte type). Fallback
+ *        blocks are chained through a small header at their start and are
+ *        given back to the fallback on rewind, same as the arena memory.
+ *
+ *        'memory_resource' makes std::pmr containers live in the arena,
+ *        their deallocations cost nothing.
+ *
+ *        The arena is not synchronized.
+ *
+ * Usage example:
+ *
+ * static auto scratch = static_arena<64 * 1024>();
+ *
+ * auto handle_request () -> void {
+ *     auto s = scope(scratch); ///< everything below is freed at the exit
+ *     auto r = memory_resource(scratch);
+ *     std::pmr::vector<int> v(&r);
+ *     ...
+ * }
+ *
+ * /// overflow into beefy storages
+ * using fallback = beefy::allocator<std::byte, decltype(storage), storage>;
+ * static auto big = static_arena<4096, fallback>();
+ */
+
+#ifndef KCPPT_ALLOCATORS_ARENA_HPP
+#define KCPPT_ALLOCATORS_ARENA_HPP
+
+#include "../pow2.hpp"
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace arena {
+
+namespace _implementation {
+
+[[nodiscard]]
+constexpr static auto align_up (
+    std::uintptr_t address, std::size_t alignment
+) noexcept -> std::uintptr_t {
+    return (address + alignment - 1u) & ~std::uintptr_t(alignment - 1u);
+}
+
+/**
+ * @brief Lives at the start of every fallback block
+ */
+struct overflow_header {
+    void* prev;
+    std::size_t size;
+};
+
+}
+
+/**
+ * @tparam Capacity -- size of the arena in bytes
+ * @tparam Fallback -- void (no fallback) or default constructible allocator
+ *         of a byte type with allocate(n) and deallocate(p, n), takes
+ *         the requests that don't fit the arena
+ */
+template <std::size_t Capacity, typename Fallback = void>
+class static_arena {
+    static_assert(Capacity != 0u);
+
+public:
+    /**
+     * @brief State of the arena to rewind to
+     */
+    struct marker {
+        std::size_t top;
+        void* overflow;
+    };
+
+private:
+    constexpr static auto _has_fallback = !std::is_void_v<Fallback>;
+
+private:
+    alignas(std::max_align_t) std::byte _buffer[Capacity];
+    /**
+     * @brief offset of the first free byte of _buffer
+     */
+    std::size_t _top;
+    /**
+     * @brief the most recent fallback block, nullptr if there are none
+     */
+    void* _overflow;
+
+public:
+    constexpr static_arena () noexcept :
+        _buffer(),
+        _top(0u),
+        _overflow(nullptr)
+    {}
+    
+    static_arena (const static_arena&) = delete;
+    auto operator= (const static_arena&) -> static_arena& = delete;
+    
+    ~static_arena () noexcept {
+        reset();
+    }
+
+public:
+    /**
+     * @param bytes
+     * @param alignment -- power of 2
+     * @return nullptr if neither the arena nor the fallback has the memory,
+     *         or the alignment is not a power of 2
+     */
+    [[nodiscard]]
+    auto allocate (
+        std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)
+    ) noexcept -> void* {
+        if ((alignment == 0u) || !pow2::is_pow2(std::size_t(alignment))) {
+            return nullptr;
+        }
+        /// zero bytes still take one, the pointer must be unique and owned
+        bytes = (bytes == 0u) ? 1u : bytes;
+        auto base = reinterpret_cast<std::uintptr_t>(_buffer);
+        auto begin = std::size_t(
+            _implementation::align_up(base + _top, alignment) - base
+        );
+        if ((begin <= Capacity) && (bytes <= Capacity - begin)) {
+            _top = begin + bytes;
+            return _buffer + begin;
+        }
+        return _allocate_overflow(bytes, alignment);
+    }
+    
+    [[nodiscard]]
+    auto mark () const noexcept -> marker {
+        return {_top, _overflow};
+    }
+    
+    /**
+     * @brief Free everything allocated after 'm' was taken,
+     *        markers taken after 'm' become invalid
+     */
+    auto rewind (const marker& m) noexcept -> void {
+        _deallocate_overflow_until(m.overflow);
+        _top = m.top;
+    }
+    
+    auto reset () noexcept -> void {
+        rewind({0u, nullptr});
+    }
+    
+    /**
+     * @return bytes taken from the arena itself, including alignment gaps
+     */
+    [[nodiscard]]
+    auto used () const noexcept -> std::size_t {
+        return _top;
+    }
+    
+    [[nodiscard]]
+    constexpr static auto capacity () noexcept -> std::size_t {
+        return Capacity;
+    }
+    
+    /**
+     * @return true if 'p' is in the arena or in one of the fallback blocks,
+     *         O(number of fallback blocks)
+     */
+    [[nodiscard]]
+    auto owns (const void* p) const noexcept -> bool {
+        auto a = reinterpret_cast<std::uintptr_t>(p);
+        auto base = reinterpret_cast<std::uintptr_t>(_buffer);
+        if ((a >= base) && (a < base + Capacity)) {
+            return true;
+        }
+        for (auto o = _overflow; o != nullptr; o = _header(o).prev) {
+            auto ob = reinterpret_cast<std::uintptr_t>(o);
+            if ((a >= ob) && (a < ob + _header(o).size)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    [[nodiscard]]
+    auto _allocate_overflow (std::size_t bytes, std::size_t alignment)
+    noexcept -> void* {
+        if constexpr (_has_fallback) {
+            using fallback_pointer_t = decltype(
+                std::declval<Fallback&>().allocate(std::size_t(1u))
+            );
+            static_assert(
+                sizeof(std::remove_pointer_t<fallback_pointer_t>) == 1u,
+                "fallback must allocate bytes"
+            );
+            
+            auto size = sizeof(_implementation::overflow_header) +
+                        alignment - 1u + bytes;
+            auto raw = Fallback().allocate(size);
+            if (raw == nullptr) {
+                return nullptr;
+            }
+            /// the block may be not aligned for the header, copy it bytewise
+            auto h = _implementation::overflow_header{_overflow, size};
+            std::memcpy(raw, &h, sizeof(h));
+            _overflow = raw;
+            return reinterpret_cast<void*>(_implementation::align_up(
+                reinterpret_cast<std::uintptr_t>(raw) + sizeof(h), alignment
+            ));
+        } else {
+            return nullptr;
+        }
+    }
+    
+    auto _deallocate_overflow_until (void* stop) noexcept -> void {
+        if constexpr (_has_fallback) {
+            using fallback_pointer_t = decltype(
+                std::declval<Fallback&>().allocate(std::size_t(1u))
+            );
+            
+            while (_overflow != stop) {
+                auto h = _header(_overflow);
+                Fallback().deallocate(
+                    static_cast<fallback_pointer_t>(_overflow), h.size
+                );
+                _overflow = h.prev;
+            }
+        }
+    }
+    
+    [[nodiscard]]
+    static auto _header (const void* o) noexcept
+    -> _implementation::overflow_header {
+        _implementation::overflow_header h {};
+        std::memcpy(&h, o, sizeof(h));
+        return h;
+    }
+};
+
+/**
+ * @brief Rewinds the arena to the state it had on the scope construction
+ */
+template <typename Arena>
+class scope {
+private:
+    Arena& _arena;
+    typename Arena::marker _marker;
+
+public:
+    explicit scope (Arena& arena) noexcept :
+        _arena(arena),
+        _marker(arena.mark())
+    {}
+    
+    scope (const scope&) = delete;
+    auto operator= (const scope&) -> scope& = delete;
+    
+    ~scope () noexcept {
+        _arena.rewind(_marker);
+    }
+};
+
+/**
+ * @brief std::pmr::memory_resource over an arena. Deallocation of the arena
+ *        memory does nothing, requests the arena can't serve go to the
+ *        upstream resource (none by default, std::bad_alloc is thrown).
+ *        Containers must not outlive the rewind of their memory.
+ */
+template <typename Arena>
+class memory_resource final : public std::pmr::memory_resource {
+private:
+    Arena& _arena;
+    std::pmr::memory_resource* _upstream;
+
+public:
+    explicit memory_resource (
+        Arena& arena,
+        std::pmr::memory_resource* upstream = std::pmr::null_memory_resource()
+    ) noexcept :
+        _arena(arena),
+        _upstream(upstream)
+    {}
+
+public:
+    [[nodiscard]]
+    auto upstream_resource () const noexcept -> std::pmr::memory_resource* {
+        return _upstream;
+    }
+
+private:
+    auto do_allocate (std::size_t bytes, std::size_t alignment)
+    -> void* final {
+        auto p = _arena.allocate(bytes, alignment);
+        if (p != nullptr) {
+            return p;
+        }
+        return _upstream->allocate(bytes, alignment);
+    }
+    
+    auto do_deallocate (void* p, std::size_t bytes, std::size_t alignment)
+    -> void final {
+        if (_arena.owns(p)) {
+            return;
+        }
+        _upstream->deallocate(p, bytes, alignment);
+    }
+    
+    [[nodiscard]]
+    auto do_is_equal (const std::pmr::memory_resource& other) const noexcept
+    -> bool final {
+        return this == &other;
+    }
+};
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_ALLOCATORS_ARENA_HPP
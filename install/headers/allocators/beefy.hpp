@@ -34,34 +34,46 @@
  *
  * @details
  *
- *        Storage_base is implied to hold three heaps that track the following:
- *        - either the pointer is allocated or not (heap_flags)
+ *        Every storage owns its pool and the control structure that tracks
+ *        which blocks of that pool are free, and hands the blocks out through
+ *        allocate_block/deallocate_block. The allocator only picks the
+ *        storage by the requested size.
  *
- *        - movement of the pointers indices along the heap itself
- *          (heap_indices), used for constant-time access to the pointer
+ *        There are two storages to choose from.
+ *
+ *        'storage' is implied to hold two heaps that track the following:
+ *        - either the pointer is allocated or not and movement of the
+ *          pointers indices along the heap itself (heap), both packed into
+ *          a single node: the flag in the highest bit, the original index in
+ *          the rest. A swap of two heap nodes touches a single array.
  *
  *        - movement of the pointers original indices (heap_indices_reversed),
  *          used for O(1) access time during deallocation when the requested
  *          pointer is being searched for
  *
- *        - non-heap sorted_pointers -- array of pointers to the internal pool
+ *        Pointers to the blocks are not stored, the pool is contiguous and
+ *        every block has the same size, so the block index is computed
+ *        from the pointer value and vice versa.
  *
- *        All of this makes this storage really chunky and fat.
- *        Each block of data in the pool will require:
- *        - one bool (heap_flags>
- *        - two std::size_t (heap_indices)
- *        - one std::uintptr_t (sorted_pointers)
- *        If (hopefully) sizeof(std::size_t) == sizeof(std::uintptr_t) the
- *        overhead table will be something like this:
+ *        Nodes and indices are of the smallest unsigned type that fits the
+ *        blocks count, so the overhead per one block of data is:
  *
- *        System    Overhead in bytes
- *        address   per one block of data
- *        16 bit    1 + 2 + 2 == 5
- *        32 bit    1 + 4 + 4 == 9
- *        64 bit    1 + 8 + 8 == 17
+ *        Blocks count     Overhead in bytes
+ *        up to 2^7        1 + 1 == 2
+ *        up to 2^15       2 + 2 == 4
+ *        up to 2^31       4 + 4 == 8
+ *        more             8 + 8 == 16
  *
  *        This is the price you pay for O(logN) allocation and deallocation.
  *
+ *        'bitmap_storage' keeps a single bit per block in 64-bit words
+ *        (1 -- free, 0 -- allocated) plus a summary bitmap with a single bit
+ *        per word (1 -- the word has at least one free block). A free block
+ *        is found with two count-trailing-zeros, a deallocated block is
+ *        located by the address arithmetic, so both operations are O(1)
+ *        for up to 4096 blocks and O(N / 4096) words scanned above that.
+ *        The overhead is about 1 bit per block on any system.
+ *
  *        The second price you pay is pure abstract interface indirection so
  *        that the allocator could traverse multiple storages with different
  *        block sizes (the type of the elements is still the same)
@@ -69,8 +81,33 @@
  *        My proposal would be to use it when your data blocks are at least as
  *        twice as big as the overhead, but this is purely a personal opinion.
  *
+ *        Every pool and control block is aligned to the cache line.
+ *
+ *        Memory can be given back without its size: the pools are sorted by
+ *        their addresses once and the owner of a pointer is found with
+ *        a binary search, O(log(storages count)). A size that doesn't match
+ *        the block falls back to the same search instead of leaking it.
+ *        Pointers no storage owns trap in debug builds (assert).
+ *
+ *        Hardened mode (define KCPPT_BEEFY_HARDENED) makes 'storage' and
+ *        'bitmap_storage' check every block they hand out and take back,
+ *        any violation prints the reason and aborts, in release builds too:
+ *        - every block is followed by a guard of 16 canary bytes, a broken
+ *          canary (overflow) is caught when the block is freed or reused
+ *        - deallocation of a free block (double free) or of a pointer that
+ *          is not a block (foreign or interior pointer) is caught from the
+ *          flags and the address arithmetic
+ *        - free blocks are filled with 0xDD, a block that is written to
+ *          while free (use after free) is caught when it is handed out again
+ *        - under AddressSanitizer the free blocks and the guards are
+ *          poisoned, so the accesses are reported right where they happen,
+ *          the whole pool is unpoisoned when the storage is destroyed
+ *        It costs the guards in memory and a fill plus a scan of the block in
+ *        time. The bytes are filled and checked for trivially copyable Ts
+ *        only.
+ *
  *        Summing up:
- *        It's beefy because of the 5..17 bytes of overhead per single data
+ *        It's beefy because of the 2..16 bytes of overhead per single data
  *        block.
  *        It's fast because this overhead allows the allocator to traverse
  *        the control heaps with logN time
@@ -79,15 +116,15 @@
  *
  * /// declare multiple storages types
  * using storage_char_0 = storage<char,    2, 1024>;
- * using storage_char_0 = storage<char,   11,  500>;
- * using storage_char_0 = storage<char,   50,   22>;
- * using storage_char_0 = storage<char, 4023,    3>;
+ * using storage_char_1 = storage<char,   11,  500>;
+ * using storage_char_2 = storage<char,   50,   22>;
+ * using storage_char_3 = bitmap_storage<char, 4023, 3>;
  *
  * /// instantiate the storages
  * static auto s0 = storage_char_0();
- * static auto s1 = storage_char_0();
- * static auto s2 = storage_char_0();
- * static auto s3 = storage_char_0();
+ * static auto s1 = storage_char_1();
+ * static auto s2 = storage_char_2();
+ * static auto s3 = storage_char_3();
  *
  * /// make std::array of pointers to these storages (virtual base ones)
  * static auto storage = make_ptrs_to_storages_array<char>(s0, s1, s2, s3);
@@ -102,20 +139,52 @@
  * auto p2 = myalloc.allocate(2222);
  * auto p3 = myalloc.allocate(2222);
  * myalloc.deallocate(p2, 2222);
- * myalloc.deallocate(p3, 2222);
+ * myalloc.deallocate(p3); ///< same, the size is not needed
  * p2 = myalloc.allocate(2222);
+ * p1 = myalloc.reallocate(p1, 1, 2); ///< same block, both fit s0
+ * p1 = myalloc.reallocate(p1, 2, 40); ///< moved to s2 with a single copy
+ *
+ * /// Same, but with per-storage usage records (live, peak, failures and
+ * /// the block fill histogram), e.g. to size the pools from real runs
+ * using counted = allocator<char, decltype(storage), storage, stats::enabled<>>;
+ * auto peak_of_s3 = counted::stats()[3].peak;
  *
  */
 
 #ifndef KCPPT_ALLOCATORS_BEEFY_HPP
 #define KCPPT_ALLOCATORS_BEEFY_HPP
 
+#include "../bitwise.hpp"
 #include "../range.hpp"
+#include "../sequence.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <tuple>
 #include <type_traits>
 
+/**
+ * @brief Define KCPPT_BEEFY_HARDENED (before any include of this file, the
+ *        same way in every translation unit) to check the storages at run
+ *        time, see the file description
+ */
+#if defined(__SANITIZE_ADDRESS__)
+#define KCPPT_BEEFY_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define KCPPT_BEEFY_ASAN 1
+#endif
+#endif
+
+#if defined(KCPPT_BEEFY_HARDENED) && defined(KCPPT_BEEFY_ASAN)
+#include <sanitizer/asan_interface.h>
+#endif
+
 namespace kcppt {
 
 namespace allocators {
@@ -124,29 +193,419 @@ namespace beefy {
 
 namespace _implementation {
 
-template <typename T, std::size_t Sz>
+template <std::size_t Sz, typename I = std::size_t>
 [[nodiscard]]
-constexpr static auto build_pointers_array (
-    T* base = nullptr, std::size_t block_size = 0
-) noexcept {
-    std::array<T*, Sz> ret {base};
-    for (auto i : range::range(1u, ret.size())) {
-        ret[i] = block_size + ret[i - 1u];
+constexpr static auto build_indices_array () noexcept {
+    std::array<I, Sz> ret {};
+    for (auto i : range::indices(ret)) {
+        ret[i] = static_cast<I>(i);
     }
     return ret;
 }
 
-template <std::size_t Sz>
+/**
+ * @brief Smallest unsigned type that holds 'Max'
+ */
+template <std::uintmax_t Max>
+using least_uint_t = std::conditional_t<
+    Max <= UINT8_MAX, std::uint8_t, std::conditional_t<
+    Max <= UINT16_MAX, std::uint16_t, std::conditional_t<
+    Max <= UINT32_MAX, std::uint32_t, std::uint64_t
+>>>;
+
+/**
+ * @brief Pools and control blocks of the storages start on their own cache
+ *        lines, so that neighbouring storages don't false-share.
+ *        64 fits x86-64 and most ARM cores, the standard
+ *        hardware_destructive_interference_size is not used since its value
+ *        may differ between compiler flags and break the ABI.
+ */
+constexpr static std::size_t cache_line_size = 64u;
+
+/**
+ * @brief Bitmap of free blocks, shared by the storages that track their
+ *        blocks with bits. Operates on the raw words so that the same code
+ *        serves both compile-time and runtime sized storages.
+ *        A set bit means 'free'.
+ *        'bits' -- one bit per block
+ *        'summary' -- one bit per word of 'bits', set if the word is not zero
+ */
+using bitmap_word_t = std::uint64_t;
+
+constexpr static auto bitmap_word_width = std::size_t(64u);
+
+[[nodiscard]]
+constexpr static auto bitmap_words_count (std::size_t nbits) noexcept
+-> std::size_t {
+    return (nbits + bitmap_word_width - 1u) / bitmap_word_width;
+}
+
 [[nodiscard]]
-constexpr static auto build_indices_array () noexcept {
-    std::array<std::size_t, Sz> ret {};
-    for (auto i : range::indices(ret)) {
-        ret[i] = i;
+constexpr static auto bitmap_summary_count (std::size_t nbits) noexcept
+-> std::size_t {
+    return bitmap_words_count(bitmap_words_count(nbits));
+}
+
+[[nodiscard]]
+constexpr static auto bitmap_bit (std::size_t i) noexcept -> bitmap_word_t {
+    return bitmap_word_t(1u) << (i % bitmap_word_width);
+}
+
+/**
+ * @brief Mark first 'nbits' blocks as free, the tail of the last word stays
+ *        zero so that it is never handed out
+ */
+constexpr static auto bitmap_fill (
+    bitmap_word_t* bits, bitmap_word_t* summary, std::size_t nbits
+) noexcept -> void {
+    auto nwords = bitmap_words_count(nbits);
+    for (auto w : range::range(nwords)) {
+        bits[w] = ~bitmap_word_t(0u);
+        summary[w / bitmap_word_width] |= bitmap_bit(w);
     }
-    return ret;
+    auto tail = nbits % bitmap_word_width;
+    if (tail != 0u) {
+        bits[nwords - 1u] = (bitmap_word_t(1u) << tail) - 1u;
+    }
+}
+
+/**
+ * @return index of the taken free block, 'nbits' if there are none
+ */
+[[nodiscard]]
+constexpr static auto bitmap_take (
+    bitmap_word_t* bits, bitmap_word_t* summary, std::size_t nbits
+) noexcept -> std::size_t {
+    auto nsummary = bitmap_summary_count(nbits);
+    for (auto s : range::range(nsummary)) {
+        if (summary[s] == 0u) {
+            continue;
+        }
+        auto w = s * bitmap_word_width +
+                 bitwise::count_trailing_zeros(summary[s]);
+        auto b = bitwise::count_trailing_zeros(bits[w]);
+        bits[w] &= bits[w] - 1u; /// clear the lowest set bit
+        if (bits[w] == 0u) {
+            summary[s] &= ~bitmap_bit(w);
+        }
+        return w * bitmap_word_width + b;
+    }
+    return nbits;
+}
+
+/**
+ * @brief Take up to 'count' free blocks, whole words at a time,
+ *        'f' is called with the index of every taken block
+ * @return number of the taken blocks
+ */
+template <typename F>
+constexpr static auto bitmap_take_n (
+    bitmap_word_t* bits, bitmap_word_t* summary, std::size_t nbits,
+    std::size_t count, F&& f
+) noexcept -> std::size_t {
+    auto taken = std::size_t(0u);
+    auto nsummary = bitmap_summary_count(nbits);
+    for (auto s : range::range(nsummary)) {
+        while ((summary[s] != 0u) && (taken != count)) {
+            auto w = s * bitmap_word_width +
+                     bitwise::count_trailing_zeros(summary[s]);
+            auto word = bits[w];
+            while ((word != 0u) && (taken != count)) {
+                f(w * bitmap_word_width + bitwise::count_trailing_zeros(word));
+                word &= word - 1u;
+                ++taken;
+            }
+            bits[w] = word;
+            if (word == 0u) {
+                summary[s] &= ~bitmap_bit(w);
+            }
+        }
+        if (taken == count) {
+            break;
+        }
+    }
+    return taken;
+}
+
+constexpr static auto bitmap_give (
+    bitmap_word_t* bits, bitmap_word_t* summary, std::size_t i
+) noexcept -> void {
+    auto w = i / bitmap_word_width;
+    bits[w] |= bitmap_bit(i);
+    summary[w / bitmap_word_width] |= bitmap_bit(w);
+}
+
+/**
+ * @brief Take the given block, it must be free
+ */
+constexpr static auto bitmap_clear (
+    bitmap_word_t* bits, bitmap_word_t* summary, std::size_t i
+) noexcept -> void {
+    auto w = i / bitmap_word_width;
+    bits[w] &= ~bitmap_bit(i);
+    if (bits[w] == 0u) {
+        summary[w / bitmap_word_width] &= ~bitmap_bit(w);
+    }
+}
+
+[[nodiscard]]
+constexpr static auto bitmap_test (
+    const bitmap_word_t* bits, std::size_t i
+) noexcept -> bool {
+    return (bits[i / bitmap_word_width] & bitmap_bit(i)) != 0u;
+}
+
+/**
+ * @brief Index of the block that starts at 'p' in a pool of
+ *        'blocks_count' blocks of 'block_size' Ts each
+ * @return 'blocks_count' if 'p' doesn't point to the start of any block
+ */
+template <typename T>
+[[nodiscard]]
+static auto pool_index (
+    const T* pool, std::size_t block_size, std::size_t blocks_count,
+    const T* p
+) noexcept -> std::size_t {
+    auto ibase = reinterpret_cast<std::uintptr_t>(pool);
+    auto ip = reinterpret_cast<std::uintptr_t>(p);
+    if (ip < ibase) {
+        return blocks_count;
+    }
+    auto offs = (ip - ibase) / sizeof(T);
+    if (((ip - ibase) % sizeof(T) != 0u) || (offs % block_size != 0u)) {
+        return blocks_count;
+    }
+    auto i = offs / block_size;
+    return (i < blocks_count) ? i : blocks_count;
+}
+
+/**
+ * @brief Start of the block that contains 'p' (not necessarily at its start)
+ * @return nullptr if 'p' is outside of the pool
+ */
+template <typename T>
+[[nodiscard]]
+static auto pool_block (
+    T* pool, std::size_t block_size, std::size_t blocks_count, const T* p
+) noexcept -> T* {
+    auto ibase = reinterpret_cast<std::uintptr_t>(pool);
+    auto ip = reinterpret_cast<std::uintptr_t>(p);
+    if ((ip < ibase) || (ip - ibase >= block_size * blocks_count * sizeof(T))) {
+        return nullptr;
+    }
+    return pool + (ip - ibase) / sizeof(T) / block_size * block_size;
+}
+
+/**
+ * @brief Hardened mode, all of it compiles to nothing without
+ *        KCPPT_BEEFY_HARDENED
+ */
+#ifdef KCPPT_BEEFY_HARDENED
+constexpr static auto hardened = true;
+#else
+constexpr static auto hardened = false;
+#endif
+
+#if defined(KCPPT_BEEFY_HARDENED) && defined(KCPPT_BEEFY_ASAN)
+constexpr static auto hardened_asan = true;
+#else
+constexpr static auto hardened_asan = false;
+#endif
+
+/**
+ * @brief every block is followed by a guard of at least canary_bytes
+ */
+constexpr static std::size_t canary_bytes = 16u;
+constexpr static unsigned char canary_byte = 0xCAu;
+/**
+ * @brief free blocks are filled with it
+ */
+constexpr static unsigned char poison_byte = 0xDDu;
+
+/**
+ * @brief Size of the guard in Ts
+ */
+template <typename T>
+constexpr static std::size_t guard_size =
+    hardened ? (canary_bytes + sizeof(T) - 1u) / sizeof(T) : 0u;
+
+/**
+ * @brief Distance between the starts of two neighbouring blocks in Ts
+ */
+template <typename T>
+[[nodiscard]]
+constexpr static auto block_stride (std::size_t block_size) noexcept
+-> std::size_t {
+    return block_size + guard_size<T>;
+}
+
+[[noreturn]]
+static inline auto hardened_trap (const char* what) noexcept -> void {
+    std::fprintf(stderr, "beefy: %s\n", what);
+    std::abort();
+}
+
+static inline auto asan_poison (const void* p, std::size_t bytes) noexcept
+-> void {
+#if defined(KCPPT_BEEFY_HARDENED) && defined(KCPPT_BEEFY_ASAN)
+    ASAN_POISON_MEMORY_REGION(p, bytes);
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+static inline auto asan_unpoison (const void* p, std::size_t bytes) noexcept
+-> void {
+#if defined(KCPPT_BEEFY_HARDENED) && defined(KCPPT_BEEFY_ASAN)
+    ASAN_UNPOISON_MEMORY_REGION(p, bytes);
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+[[nodiscard]]
+static inline auto is_filled (
+    const void* p, std::size_t bytes, unsigned char c
+) noexcept -> bool {
+    auto b = static_cast<const unsigned char*>(p);
+    for (auto i : range::range(bytes)) {
+        if (b[i] != c) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Only the bytes of trivially copyable Ts are filled and checked
+ */
+template <typename T>
+constexpr static auto hardened_bytes =
+    hardened && std::is_trivially_copyable_v<T>;
+
+/**
+ * @brief Poison every block and write the canaries, once on construction
+ */
+template <typename T>
+static auto harden_pool (
+    T* pool, std::size_t block_size, std::size_t blocks_count
+) noexcept -> void {
+    if constexpr (hardened_bytes<T>) {
+        auto stride = block_stride<T>(block_size);
+        for (auto i : range::range(blocks_count)) {
+            auto b = pool + i * stride;
+            std::memset(b, poison_byte, block_size * sizeof(T));
+            std::memset(b + block_size, canary_byte, guard_size<T> * sizeof(T));
+            asan_poison(b, stride * sizeof(T));
+        }
+    }
+}
+
+template <typename T>
+[[nodiscard]]
+static auto canary_is_intact (const T* b, std::size_t block_size) noexcept
+-> bool {
+    /// the guard stays poisoned under asan, it reports overflows itself
+    return hardened_asan ||
+           is_filled(b + block_size, guard_size<T> * sizeof(T), canary_byte);
+}
+
+/**
+ * @brief Called for every block the storage hands out
+ */
+template <typename T>
+static auto harden_on_allocate (T* b, std::size_t block_size) noexcept
+-> void {
+    if constexpr (hardened_bytes<T>) {
+        asan_unpoison(b, block_size * sizeof(T));
+        if (!is_filled(b, block_size * sizeof(T), poison_byte)) {
+            hardened_trap("a free block was written to (use after free)");
+        }
+        if (!canary_is_intact(b, block_size)) {
+            hardened_trap("the canary after a block is broken (overflow)");
+        }
+    }
+}
+
+/**
+ * @param b -- start of the block, nullptr if the pointer is not a block
+ * @param was_allocated -- state of the block before the deallocation
+ */
+template <typename T>
+static auto harden_on_deallocate (
+    T* b, std::size_t block_size, bool was_allocated
+) noexcept -> void {
+    if constexpr (hardened) {
+        if (b == nullptr) {
+            hardened_trap("the pointer is not a block of the storage");
+        }
+        if (!was_allocated) {
+            hardened_trap("the block is already free (double free)");
+        }
+    }
+    if constexpr (hardened_bytes<T>) {
+        if (!canary_is_intact(b, block_size)) {
+            hardened_trap("the canary after a block is broken (overflow)");
+        }
+        std::memset(b, poison_byte, block_size * sizeof(T));
+        asan_poison(b, block_size * sizeof(T));
+    }
+}
+
+/**
+ * @brief None of the storages of an allocator owns the pointer
+ */
+static inline auto foreign_pointer () noexcept -> void {
+    if constexpr (hardened) {
+        hardened_trap("the pointer is not a block of any storage");
+    }
+    assert(!"beefy: the pointer is not a block of any storage");
 }
+
+/**
+ * @brief Search for appropriate storage, logN given that the pointers
+ *        are sorted by c[i]->block_size() and every block_size()
+ *        is unique in that container.
+ * @return index of the storage, c.size() if none fits
+ */
+template <typename SequenceContainer>
+[[nodiscard]]
+static auto search_fitting_container (
+    const SequenceContainer& c, std::size_t nT
+) noexcept -> std::size_t {
+    auto container_end = c.size();
+    auto il = std::size_t(0u); /// start left border at the start
+    auto ir = container_end;   /// start right border past the end
+    /**
+     * @brief Simple binary search for an exact match
+     */
+    while (il != ir) {
+        auto im = (il + ir) / 2u;
+        auto m = c[im]->block_size(); /// maybe cache it somehow?
+        
+        if (nT > m) {
+            il = im + 1u;  /// move left border
+        } else if (nT < m) {
+            ir = im;       /// move right border
+        } else {
+            return im;     /// exact size match
+        }
+    }
     
+    /**
+     * @brief If we got here, check if the 'next' greater element will fit
+     */
+    if ((ir < container_end) &&
+        (nT < c[ir]->block_size()) &&
+        (nT != 0u)) {
+        return ir;
+    }
     
+    return container_end; /// return 'past the end'
+}
+
 }
 
 template <typename T>
@@ -163,28 +622,60 @@ public:
     [[nodiscard]]
     virtual auto blocks_count () const noexcept -> std::size_t = 0;
     /**
-     * @return pointer to an array of size 'blocks_count' that contains
-     *         boolean 'heap_flags', true if allocated or false if deallocated
+     * @return pointer to a free block which becomes allocated,
+     *         nullptr if every block is already allocated
      */
     [[nodiscard]]
-    virtual auto heap_flags () noexcept -> bool* = 0;
+    virtual auto allocate_block () noexcept -> T* = 0;
     /**
-     * @return heap of original indices, tracks where the original indices were
+     * @brief Return the block back to the storage,
+     *        pointers that are not owned by this storage are ignored
+     */
+    virtual auto deallocate_block (T* p) noexcept -> void = 0;
+    /**
+     * @brief Allocate up to 'count' blocks at once, pointers are written
+     *        to 'out'
+     * @return number of allocated blocks, less than 'count' if the storage
+     *         ran out of free blocks
+     */
+    [[nodiscard]]
+    virtual auto allocate_blocks (T** out, std::size_t count) noexcept
+    -> std::size_t = 0;
+    /**
+     * @brief Return 'count' blocks at once,
+     *        pointers that are not owned by this storage are ignored
+     */
+    virtual auto deallocate_blocks (T* const* ps, std::size_t count) noexcept
+    -> void = 0;
+    /**
+     * @return true if 'p' points to the start of a block in the pool
+     *         of this storage, allocated or not
+     */
+    [[nodiscard]]
+    virtual auto owns (const T* p) const noexcept -> bool = 0;
+    /**
+     * @return true if 'p' points to the start of a block in the pool
+     *         of this storage and the block is allocated
+     */
+    [[nodiscard]]
+    virtual auto is_allocated (const T* p) const noexcept -> bool = 0;
+    /**
+     * @return start of the block that contains 'p' anywhere inside,
+     *         nullptr if 'p' is not in the pool of this storage
      */
     [[nodiscard]]
-    virtual auto heap_indices () noexcept -> std::size_t* = 0;
+    virtual auto block_of (const T* p) noexcept -> T* = 0;
     /**
-     * @return same for a reversed table of indices
-     *         (provides constant index search instead of linear)
+     * @return first T of the pool
      */
     [[nodiscard]]
-    virtual auto heap_indices_reversed () noexcept -> std::size_t* = 0;
+    virtual auto pool_begin () const noexcept -> const T* = 0;
     /**
-     * @return pointer to an array of pointers to each block of T in the
-     *         internal pool
+     * @return past the last T of the pool, the pool may be larger than
+     *         its blocks (hardened mode guards)
      */
     [[nodiscard]]
-    virtual auto sorted_pointers () const noexcept -> T* const* = 0;
+    virtual auto pool_end () const noexcept -> const T* = 0;
     
     virtual ~storage_base () noexcept = default;
 };
@@ -195,54 +686,76 @@ class storage final : public storage_base<T> {
     static_assert(TBlockSize != 0);
     static_assert(TBlocksCount != 0);
 
+public:
+    constexpr static auto block_size_v = TBlockSize;
+    constexpr static auto blocks_count_v = TBlocksCount;
+
 private:
-    T _pool_of_T[TBlockSize * TBlocksCount];
-    
-    /******
-     * @brief _heap_flags, _heap_pointers and _heap_indices are a part of a
-     *        single heap-like data structure. Heap elements are sink, float and
-     *        sorted based on values in _heap_flags.
-     *        Values of _heap_pointers and _heap_indices are just dragged along
-     *        according to the swapped indices.
-     *        _heap_indices contains the original indices and is used to monitor
-     *        where the original flags and pointers are located.
+    /**
+     * @brief blocks are followed by the guards in hardened mode
      */
+    constexpr static auto _stride =
+        _implementation::block_stride<T>(TBlockSize);
     
     /**
-     * @brief heap of flags, allocated -- 1, deallocated -- 0
+     * @brief allocated flag in the highest bit, original index in the rest
      */
-    std::array<bool, TBlocksCount> _heap_flags;
-    /**
-     * @brief heap of indices, used to watch the original element position
-     *        against the heap indices
+    using node_t = _implementation::least_uint_t<
+        (std::uintmax_t(TBlocksCount) - 1u) * 2u + 1u
+    >;
+    
+    constexpr static auto _allocated_bit =
+        node_t(node_t(1u) << (sizeof(node_t) * CHAR_BIT - 1u));
+
+private:
+    alignas(_implementation::cache_line_size)
+    T _pool_of_T[_stride * TBlocksCount];
+    
+    /******
+     * @brief _heap and _heap_indices_reversed are a part of a single
+     *        heap-like data structure. Heap elements are sink, float and
+     *        sorted based on the allocated flags of the nodes.
+     *        Original indices are just dragged along with the flags,
+     *        _heap_indices_reversed is used to monitor where the original
+     *        indices are located.
      */
-    std::array<std::size_t, TBlocksCount> _heap_indices;
+    
     /**
-     * @brief heap of reversed indices, used to track the original element
-     *        position against the _sorted_pointers indices
+     * @brief heap of nodes, allocated flag -- 1, deallocated -- 0,
+     *        the original index is used to watch the original element
+     *        position against the heap indices
      */
-    std::array<std::size_t, TBlocksCount> _heap_indices_reversed;
+    alignas(_implementation::cache_line_size)
+    std::array<node_t, TBlocksCount> _heap;
     /**
-     * @brief sorted array of const pointers to each block in _pool_of_T
+     * @brief heap of reversed indices, used to track the original element
+     *        position against the blocks of _pool_of_T
      */
-    const std::array<T*, TBlocksCount> _sorted_pointers;
+    alignas(_implementation::cache_line_size)
+    std::array<node_t, TBlocksCount> _heap_indices_reversed;
 
 public:
     storage () noexcept :
         _pool_of_T(),
-        _heap_flags(),
-        _heap_indices(
-            _implementation::build_indices_array<TBlocksCount>()
+        _heap(
+            _implementation::build_indices_array<TBlocksCount, node_t>()
         ),
         _heap_indices_reversed(
-            _implementation::build_indices_array<TBlocksCount>()
-        ),
-        _sorted_pointers(
-            _implementation::build_pointers_array<T, TBlocksCount>
-                (_pool_of_T, TBlockSize)
-        ) {}
+            _implementation::build_indices_array<TBlocksCount, node_t>()
+        )
+    {
+        _implementation::harden_pool(_pool_of_T, TBlockSize, TBlocksCount);
+    }
     
-    ~storage () = default;
+    /**
+     * @brief The pool goes back to the stack or the heap with the object,
+     *        it must not stay poisoned
+     */
+    ~storage () {
+        if constexpr (_implementation::hardened_asan) {
+            _implementation::asan_unpoison(_pool_of_T, sizeof(_pool_of_T));
+        }
+    }
 
 public:
     [[nodiscard]]
@@ -256,247 +769,132 @@ public:
     }
     
     [[nodiscard]]
-    virtual auto heap_flags () noexcept -> bool* final {
-        return _heap_flags.data();
+    virtual auto allocate_block () noexcept -> T* final {
+        if (_heap_top_is_allocated()) { ///< O(1)
+            return nullptr;
+        }
+        
+        auto p = _heap_top_pointer(); ///< O(1)
+        _heap_top_mark_as_allocated(); ///< O(1)
+        _heap_top_sink(); ///< O(logn)
+        _implementation::harden_on_allocate(p, TBlockSize);
+        return p;
+    }
+    
+    virtual auto deallocate_block (T* p) noexcept -> void final {
+        auto ip = _search_pointer_original_index(p); ///< O(1)
+        if (_index_out_of_bounds(ip)) { ///< O(1)
+            _implementation::harden_on_deallocate<T>(
+                nullptr, TBlockSize, false
+            );
+            return;
+        }
+        
+        auto iheap = _heap_position_of_original_element(ip); ///< O(1)
+        _implementation::harden_on_deallocate(
+            p, TBlockSize, _heap_flag(iheap)
+        );
+        _heap_mark_as_deallocated(iheap); ///< O(1)
+        _heap_el_float(iheap); ///< O(logn)
     }
     
     [[nodiscard]]
-    virtual auto heap_indices () noexcept -> std::size_t* final {
-        return _heap_indices.data();
+    virtual auto allocate_blocks (T** out, std::size_t count) noexcept
+    -> std::size_t final {
+        auto n = std::size_t(0u);
+        while ((n != count) && !_heap_top_is_allocated()) { ///< O(1)
+            out[n] = _heap_top_pointer(); ///< O(1)
+            _heap_top_mark_as_allocated(); ///< O(1)
+            _heap_top_sink(); ///< O(logn)
+            _implementation::harden_on_allocate(out[n++], TBlockSize);
+        }
+        return n;
+    }
+    
+    virtual auto deallocate_blocks (T* const* ps, std::size_t count) noexcept
+    -> void final {
+        for (auto i : range::range(count)) {
+            storage::deallocate_block(ps[i]);
+        }
     }
     
     [[nodiscard]]
-    virtual auto heap_indices_reversed () noexcept -> std::size_t* final {
-        return _heap_indices_reversed.data();
+    virtual auto owns (const T* p) const noexcept -> bool final {
+        return _search_pointer_original_index(p) != TBlocksCount;
     }
     
     [[nodiscard]]
-    virtual auto sorted_pointers () const noexcept -> T* const* final {
-        return _sorted_pointers.data();
-    }
-};
-
-template <
-    template <typename, std::size_t...> class FixedSequenceContainer,
-    typename T,
-    std::size_t...Sizes
->
-struct ptrs_to_storages_container {
-    using type = FixedSequenceContainer<storage_base<T>*, Sizes...>;
-};
-
-template <
-    template <typename, std::size_t...> class FixedSequenceContainer,
-    typename T,
-    std::size_t...Sizes
->
-using ptr_to_storages_container_t =
-typename ptrs_to_storages_container<FixedSequenceContainer, T, Sizes...>::type;
-
-template <
-    typename T,
-    std::size_t...Sizes
->
-using ptrs_to_storages_array_t =
-typename ptrs_to_storages_container<std::array, T, Sizes...>::type;
-
-template <
-    template <typename, std::size_t...> class FixedSequenceContainer,
-    typename T,
-    typename...Ss
->
-constexpr auto make_ptrs_to_storages_container (Ss&&...ss) noexcept {
-    ptr_to_storages_container_t<
-        FixedSequenceContainer, T, sizeof...(ss)
-    > ret {&ss...};
-    return ret;
-}
-
-template <
-    typename T,
-    typename...Ss
->
-constexpr auto make_ptrs_to_storages_array (Ss&& ...ss) noexcept {
-    ptrs_to_storages_array_t<
-        T, sizeof...(ss)
-    > ret {&ss...};
-    return ret;
-}
-
-/**
- * @brief
- * @tparam T
- * @tparam SequenceContainer -- any SequenceContainer class.
- * @tparam Container -- reference to SequenceContainer,
- *         the pointers inside must satisfy two requirements:
- *         -- they are ascending-sorted by storage's block_size
- *         -- every block_size must be unique (blocks_count can be the same)
- *         i.e. sort them by Container[i]->block_size()
- */
-template <
-    typename T,
-    typename SequenceContainer,
-    SequenceContainer& Container
->
-class allocator {
-    static_assert(!std::is_void_v<T>);
-    static_assert(
-        std::is_same_v<
-            typename SequenceContainer::value_type,
-            storage_base<T>*
-        >
-    );
-    /**
-     * @brief Amortizing variables
-     */
-    std::size_t _block_size;
-    std::size_t _blocks_count;
-    bool* _heap_flags;
-    std::size_t* _heap_indices;
-    std::size_t* _heap_indices_reversed;
-    T* const* _sorted_pointers;
-
-public:
-    constexpr allocator () noexcept :
-    _block_size(),
-    _blocks_count(),
-    _heap_flags(),
-    _heap_indices(),
-    _heap_indices_reversed(),
-    _sorted_pointers()
-    {}
-
-public:
-    [[nodiscard]]
-    auto allocate (std::size_t nT) noexcept -> T* {
-        auto i = _search_fitting_container(nT); ///< O(logn)
-        if (_container_index_out_of_bounds(i)) { ///< O(1)
-            return nullptr;
-        }
-        _amortize(i); ///< O(1)
-        
-        if (_heap_top_is_allocated()) { ///< O(1)
-            return nullptr;
-        }
-        
-        auto p = _heap_top_pointer(); ///< O(1)
-        _heap_top_mark_as_allocated(); ///< O(1)
-        _heap_top_sink(); ///< O(logn)
-        return p;
-    }
-    
-    auto deallocate (T* p, std::size_t nT) noexcept -> void {
-        auto i = _search_fitting_container(nT); ///< O(logn)
-        if (_container_index_out_of_bounds(i)) { ///< O(1)
-            return;
-        }
-        _amortize(i); ///< O(1)
-        
-        auto ip = _search_pointer_original_index(p); ///< O(logn)
-        if (_index_out_of_bounds(ip)) { ///< O(1)
-            return;
-        }
-        
-        auto iheap = _heap_position_of_original_element(ip); ///< O(1)
-        _heap_mark_as_deallocated(iheap); ///< O(1)
-        _heap_el_float(iheap); ///< O(logn)
+    virtual auto is_allocated (const T* p) const noexcept -> bool final {
+        auto ip = _search_pointer_original_index(p); ///< O(1)
+        return (ip != TBlocksCount) &&
+               _heap_flag(_heap_indices_reversed[ip]); ///< O(1)
+    }
+    
+    [[nodiscard]]
+    virtual auto block_of (const T* p) noexcept -> T* final {
+        return _implementation::pool_block(
+            _pool_of_T, _stride, TBlocksCount, p
+        );
+    }
+    
+    [[nodiscard]]
+    virtual auto pool_begin () const noexcept -> const T* final {
+        return _pool_of_T;
+    }
+    
+    [[nodiscard]]
+    virtual auto pool_end () const noexcept -> const T* final {
+        return _pool_of_T + _stride * TBlocksCount;
     }
 
 private:
-    /**
-     * @brief
-     * @param i
-     * @return
-     */
-    auto _amortize (std::size_t i) noexcept {
-        auto& s = *Container[i];
-        _block_size = s.block_size();
-        _blocks_count = s.blocks_count();
-        _heap_flags = s.heap_flags();
-        _heap_indices = s.heap_indices();
-        _heap_indices_reversed = s.heap_indices_reversed();
-        _sorted_pointers = s.sorted_pointers();
-    }
-    
-    /**
-     * @brief Search for appropriate storage, logN given that the pointers
-     *        are sorted by Container[i]->block_size() and every block_size()
-     *        is unique in that container.
-     */
-    [[nodiscard]]
-    auto _search_fitting_container (std::size_t nT) noexcept -> std::size_t {
-        auto container_end = Container.size();
-        auto il = 0u;          /// start left border at the start
-        auto ir = container_end; /// start right border past the end
-        /**
-         * @brief Simple binary search for an exact match
-         */
-        while (il != ir) {
-            auto im = (il + ir) / 2u;
-            auto m = Container[im]->block_size(); /// maybe cache it somehow?
-            
-            if (nT > m) {
-                il = im + 1u;  /// move left border
-            } else if (nT < m) {
-                ir = im;       /// move right border
-            } else {
-                return im;     /// exact size match
-            }
-        }
-        
-        /**
-         * @brief If we got here, check if the 'next' greater element will fit
-         */
-        if ((ir < container_end) &&
-            (nT < Container[ir]->block_size()) &&
-            (nT != 0u)) {
-            return ir;
-        }
-        
-        return container_end; /// return 'past the end'
-    }
-    
-    [[nodiscard]]
-    auto _container_index_out_of_bounds (std::size_t i) const noexcept ->
-    bool {
-        return i >= Container.size();
-    }
-    
     /**
      * @brief heap operations
      */
     auto _heap_top_mark_as_allocated () noexcept -> void {
-        _heap_flags[0u] = true;
+        _heap[0u] |= _allocated_bit;
     }
     
     auto _heap_mark_as_deallocated (std::size_t i) noexcept -> void {
-        _heap_flags[i] = false;
+        _heap[i] &= node_t(~_allocated_bit);
     }
     
     [[nodiscard]]
     auto _heap_top_is_allocated () noexcept -> bool {
-        return _heap_flags[0u];
+        return _heap_flag(0u);
     }
     
     [[nodiscard]]
     auto _heap_top_is_deallocated () noexcept -> bool {
-        return !_heap_flags[0u];
+        return !_heap_flag(0u);
     }
     
     [[nodiscard]]
     auto _heap_top_pointer () noexcept -> T* {
-        return _sorted_pointers[_heap_indices[0u]];
+        return _pool_of_T + _heap_index(0u) * _stride;
     }
     
     auto _heap_top_sink () noexcept -> void {
         _heap_el_sink(0u);
     }
     
+    [[nodiscard]]
+    auto _heap_flag (std::size_t i) const noexcept -> bool {
+        return (_heap[i] & _allocated_bit) != 0u;
+    }
+    
+    /**
+     * @return original index of the heap element
+     */
+    [[nodiscard]]
+    auto _heap_index (std::size_t i) const noexcept -> std::size_t {
+        return _heap[i] & node_t(~_allocated_bit);
+    }
+    
     auto _heap_swap (std::size_t i0, std::size_t i1) noexcept -> void {
-        auto ri0 = _heap_indices[i0];
-        auto ri1 = _heap_indices[i1];
-        std::swap(_heap_flags[i0], _heap_flags[i1]);
-        std::swap(_heap_indices[i0], _heap_indices[i1]);
+        auto ri0 = _heap_index(i0);
+        auto ri1 = _heap_index(i1);
+        std::swap(_heap[i0], _heap[i1]);
         std::swap(_heap_indices_reversed[ri0], _heap_indices_reversed[ri1]);
     }
     
@@ -513,21 +911,21 @@ private:
         auto ret = i;
         
         auto il = 2 * i + 1u;
-        if (il >= _blocks_count) {
+        if (il >= TBlocksCount) {
             return ret;
         }
         
-        if (_heap_flags[i] > _heap_flags[il]) {
+        if (_heap_flag(i) > _heap_flag(il)) {
             _heap_swap(i, il);
             ret = il;
         }
         
         auto ir = 2 * i + 2u;
-        if (ir >= _blocks_count) {
+        if (ir >= TBlocksCount) {
             return ret;
         }
         
-        if (_heap_flags[i] > _heap_flags[ir]) {
+        if (_heap_flag(i) > _heap_flag(ir)) {
             _heap_swap(i, ir);
             ret = (ret == il) ? il : ir;
         }
@@ -550,17 +948,18 @@ private:
     }
     
     auto _heap_el_float (std::size_t i) noexcept -> void {
-        do {
+        /// the top has no parent, check before computing one
+        while (i != 0u) {
             auto i_even = ((i & 0b1u) == 0u);
             auto ip = i / 2u - i_even; /// parent index
             
-            if (_heap_flags[ip] > _heap_flags[i]) {
+            if (_heap_flag(ip) > _heap_flag(i)) {
                 _heap_swap(ip, i);
                 i = ip;
             } else {
                 break;
             }
-        } while (i != 0);
+        }
     }
     
     /**
@@ -580,40 +979,880 @@ private:
      */
     
     /**
-     * @brief  Used for logN access in deallocation
+     * @brief  Used for constant access in deallocation
      * @param p
-     * @return
+     * @return 'past the end' if p is not a start of any block in the pool
      */
     [[nodiscard]]
-    auto _search_pointer_original_index (const T* p)
+    auto _search_pointer_original_index (const T* p) const
     noexcept -> std::size_t {
-        auto il = 0llu;        /// start left border at the start
-        auto ir = _blocks_count; /// start right border past the end
-        /**
-         * @brief Simple binary search for an exact match
-         */
-        while (il != ir) {
-            auto im = (il + ir) / 2u;
-            auto m = _sorted_pointers[im];
-            
-            if (p > m) {
-                il = im + 1u;  /// move left border
-            } else if (p < m) {
-                ir = im;       /// move right border
+        return _implementation::pool_index(
+            _pool_of_T, _stride, TBlocksCount, p
+        );
+    }
+    
+    [[nodiscard]]
+    auto _index_out_of_bounds (std::size_t i) noexcept -> bool {
+        return i >= TBlocksCount;
+    }
+};
+
+/**
+ * @brief Same pool as in 'storage', but the free blocks are tracked with
+ *        a two-level bitmap instead of the heaps (see the file description)
+ */
+template <typename T, std::size_t TBlockSize, std::size_t TBlocksCount>
+class bitmap_storage final : public storage_base<T> {
+    static_assert(!std::is_void_v<T>);
+    static_assert(TBlockSize != 0);
+    static_assert(TBlocksCount != 0);
+
+public:
+    constexpr static auto block_size_v = TBlockSize;
+    constexpr static auto blocks_count_v = TBlocksCount;
+
+private:
+    /**
+     * @brief blocks are followed by the guards in hardened mode
+     */
+    constexpr static auto _stride =
+        _implementation::block_stride<T>(TBlockSize);
+    
+    using word_t = _implementation::bitmap_word_t;
+    
+    constexpr static auto _words_count =
+        _implementation::bitmap_words_count(TBlocksCount);
+    constexpr static auto _summary_count =
+        _implementation::bitmap_summary_count(TBlocksCount);
+
+private:
+    alignas(_implementation::cache_line_size)
+    T _pool_of_T[_stride * TBlocksCount];
+    /**
+     * @brief one bit per block, free -- 1, allocated -- 0
+     */
+    alignas(_implementation::cache_line_size)
+    std::array<word_t, _words_count> _free_bits;
+    /**
+     * @brief one bit per word of _free_bits, set if the word has free blocks
+     */
+    std::array<word_t, _summary_count> _free_words;
+
+public:
+    bitmap_storage () noexcept :
+        _pool_of_T(),
+        _free_bits(),
+        _free_words()
+    {
+        _implementation::bitmap_fill(
+            _free_bits.data(), _free_words.data(), TBlocksCount
+        );
+        _implementation::harden_pool(_pool_of_T, TBlockSize, TBlocksCount);
+    }
+    
+    ~bitmap_storage () {
+        if constexpr (_implementation::hardened_asan) {
+            _implementation::asan_unpoison(_pool_of_T, sizeof(_pool_of_T));
+        }
+    }
+
+public:
+    [[nodiscard]]
+    virtual auto block_size () const noexcept -> std::size_t final {
+        return TBlockSize;
+    }
+    
+    [[nodiscard]]
+    virtual auto blocks_count () const noexcept -> std::size_t final {
+        return TBlocksCount;
+    }
+    
+    [[nodiscard]]
+    virtual auto allocate_block () noexcept -> T* final {
+        auto i = _implementation::bitmap_take(
+            _free_bits.data(), _free_words.data(), TBlocksCount
+        ); ///< O(1)
+        if (i == TBlocksCount) {
+            return nullptr;
+        }
+        auto p = _pool_of_T + i * _stride;
+        _implementation::harden_on_allocate(p, TBlockSize);
+        return p;
+    }
+    
+    virtual auto deallocate_block (T* p) noexcept -> void final {
+        auto i = _implementation::pool_index(
+            _pool_of_T, _stride, TBlocksCount, p
+        ); ///< O(1)
+        if (i == TBlocksCount) {
+            _implementation::harden_on_deallocate<T>(
+                nullptr, TBlockSize, false
+            );
+            return;
+        }
+        _implementation::harden_on_deallocate(
+            p, TBlockSize,
+            !_implementation::bitmap_test(_free_bits.data(), i)
+        );
+        _implementation::bitmap_give(
+            _free_bits.data(), _free_words.data(), i
+        ); ///< O(1)
+    }
+    
+    [[nodiscard]]
+    virtual auto allocate_blocks (T** out, std::size_t count) noexcept
+    -> std::size_t final {
+        auto n = std::size_t(0u);
+        return _implementation::bitmap_take_n(
+            _free_bits.data(), _free_words.data(), TBlocksCount, count,
+            [this, out, &n](std::size_t i) {
+                out[n] = _pool_of_T + i * _stride;
+                _implementation::harden_on_allocate(out[n++], TBlockSize);
+            }
+        ); ///< O(count / 64)
+    }
+    
+    virtual auto deallocate_blocks (T* const* ps, std::size_t count) noexcept
+    -> void final {
+        for (auto i : range::range(count)) {
+            bitmap_storage::deallocate_block(ps[i]);
+        }
+    }
+    
+    [[nodiscard]]
+    virtual auto owns (const T* p) const noexcept -> bool final {
+        return _implementation::pool_index(
+            _pool_of_T, _stride, TBlocksCount, p
+        ) != TBlocksCount;
+    }
+    
+    [[nodiscard]]
+    virtual auto is_allocated (const T* p) const noexcept -> bool final {
+        auto i = _implementation::pool_index(
+            _pool_of_T, _stride, TBlocksCount, p
+        ); ///< O(1)
+        return (i != TBlocksCount) &&
+               !_implementation::bitmap_test(_free_bits.data(), i);
+    }
+    
+    [[nodiscard]]
+    virtual auto block_of (const T* p) noexcept -> T* final {
+        return _implementation::pool_block(
+            _pool_of_T, _stride, TBlocksCount, p
+        );
+    }
+    
+    [[nodiscard]]
+    virtual auto pool_begin () const noexcept -> const T* final {
+        return _pool_of_T;
+    }
+    
+    [[nodiscard]]
+    virtual auto pool_end () const noexcept -> const T* final {
+        return _pool_of_T + _stride * TBlocksCount;
+    }
+};
+
+template <
+    template <typename, std::size_t...> class FixedSequenceContainer,
+    typename T,
+    std::size_t...Sizes
+>
+struct ptrs_to_storages_container {
+    using type = FixedSequenceContainer<storage_base<T>*, Sizes...>;
+};
+
+template <
+    template <typename, std::size_t...> class FixedSequenceContainer,
+    typename T,
+    std::size_t...Sizes
+>
+using ptr_to_storages_container_t =
+typename ptrs_to_storages_container<FixedSequenceContainer, T, Sizes...>::type;
+
+template <
+    typename T,
+    std::size_t...Sizes
+>
+using ptrs_to_storages_array_t =
+typename ptrs_to_storages_container<std::array, T, Sizes...>::type;
+
+template <
+    template <typename, std::size_t...> class FixedSequenceContainer,
+    typename T,
+    typename...Ss
+>
+constexpr auto make_ptrs_to_storages_container (Ss&&...ss) noexcept {
+    ptr_to_storages_container_t<
+        FixedSequenceContainer, T, sizeof...(ss)
+    > ret {&ss...};
+    return ret;
+}
+
+template <
+    typename T,
+    typename...Ss
+>
+constexpr auto make_ptrs_to_storages_array (Ss&& ...ss) noexcept {
+    ptrs_to_storages_array_t<
+        T, sizeof...(ss)
+    > ret {&ss...};
+    return ret;
+}
+
+namespace _implementation {
+
+template <typename C, typename = void>
+struct is_fixed_size : std::false_type {};
+
+template <typename C>
+struct is_fixed_size<C, std::void_t<decltype(std::tuple_size<C>::value)>> :
+    std::true_type {};
+
+/**
+ * @brief Pools of the storages sorted by their addresses
+ */
+template <std::size_t N>
+struct address_ranges {
+    std::array<std::uintptr_t, N> begins;
+    std::array<std::uintptr_t, N> ends;
+    /**
+     * @brief index of the storage in the container
+     */
+    std::array<std::size_t, N> indices;
+};
+
+template <typename T, std::size_t N, typename SequenceContainer>
+[[nodiscard]]
+static auto build_address_ranges (const SequenceContainer& c) noexcept
+-> address_ranges<N> {
+    address_ranges<N> r {};
+    for (auto i : range::range(N)) {
+        auto b = reinterpret_cast<std::uintptr_t>(c[i]->pool_begin());
+        auto e = reinterpret_cast<std::uintptr_t>(c[i]->pool_end());
+        /// insertion sort, there are just a few storages
+        auto k = i;
+        for (; (k != 0u) && (r.begins[k - 1u] > b); --k) {
+            r.begins[k] = r.begins[k - 1u];
+            r.ends[k] = r.ends[k - 1u];
+            r.indices[k] = r.indices[k - 1u];
+        }
+        r.begins[k] = b;
+        r.ends[k] = e;
+        r.indices[k] = i;
+    }
+    return r;
+}
+
+/**
+ * @brief Capacity of the on-stack buffer 'deallocate_owned_blocks' gathers
+ *        the blocks of one storage in
+ */
+constexpr static auto owned_batch_size = std::size_t(64u);
+
+/**
+ * @brief Give the blocks of 'ps' that 's' owns back to it with
+ *        deallocate_blocks, at most 'owned_batch_size' per call, and pass the
+ *        others to 'other' one by one.
+ *        Only owned blocks reach the storage, hardened storages trap on any
+ *        block that is not theirs.
+ */
+template <typename T, typename Storage, typename F>
+static auto deallocate_owned_blocks (
+    Storage& s, T* const* ps, std::size_t count, F&& other
+) noexcept -> void {
+    std::array<T*, owned_batch_size> owned;
+    auto n = std::size_t(0u);
+    for (auto k : range::range(count)) {
+        if (!s.owns(ps[k])) { ///< O(1)
+            other(ps[k]);
+            continue;
+        }
+        owned[n++] = ps[k];
+        if (n == owned.size()) {
+            s.deallocate_blocks(owned.data(), n);
+            n = 0u;
+        }
+    }
+    if (n != 0u) {
+        s.deallocate_blocks(owned.data(), n);
+    }
+}
+
+/**
+ * @return index of the storage whose pool holds 'p', N if none
+ */
+template <std::size_t N>
+[[nodiscard]]
+static auto search_address_ranges (
+    const address_ranges<N>& r, const void* p
+) noexcept -> std::size_t {
+    auto a = reinterpret_cast<std::uintptr_t>(p);
+    auto il = std::size_t(0u);
+    auto ir = N;
+    while (il != ir) { ///< first pool that begins after 'p'
+        auto im = (il + ir) / 2u;
+        if (r.begins[im] <= a) {
+            il = im + 1u;
+        } else {
+            ir = im;
+        }
+    }
+    if ((il == 0u) || (a >= r.ends[il - 1u])) {
+        return N;
+    }
+    return r.indices[il - 1u];
+}
+
+/**
+ * @brief Find the storage that owns 'p' by its address alone.
+ *        For fixed size containers the pools are looked up in a table
+ *        sorted by the addresses, O(logn), the table is built on the first
+ *        call (pools never move). Other containers are scanned, O(n).
+ * @return index of the storage, Container.size() if none
+ */
+template <typename T, typename SequenceContainer, SequenceContainer& Container>
+[[nodiscard]]
+static auto search_owning_container (const T* p) noexcept -> std::size_t {
+    if constexpr (is_fixed_size<SequenceContainer>::value) {
+        constexpr auto n = std::tuple_size_v<SequenceContainer>;
+        static const auto ranges = build_address_ranges<T, n>(Container);
+        return search_address_ranges(ranges, p);
+    } else {
+        for (auto i : range::indices(Container)) {
+            if (Container[i]->owns(p)) {
+                return i;
+            }
+        }
+        return Container.size();
+    }
+}
+
+}
+
+/**
+ * @brief Opt-in allocation statistics, selected by the allocators' 'Stats'
+ *        template parameter.
+ *        'disabled' has no data and every hook is discarded at compile time,
+ *        'enabled' keeps a 'record' per storage.
+ *        Records are not synchronized, keep them for single-threaded use.
+ */
+namespace stats {
+
+/**
+ * @brief Counters of a single storage
+ * @tparam Bins -- resolution of the block fill histogram
+ */
+template <std::size_t Bins>
+struct record {
+    /**
+     * @brief blocks allocated right now
+     */
+    std::size_t live;
+    /**
+     * @brief maximum of 'live' ever reached
+     */
+    std::size_t peak;
+    /**
+     * @brief allocations that found the storage exhausted
+     */
+    std::size_t failures;
+    /**
+     * @brief sums of the requested Ts and of the Ts actually handed out,
+     *        1 - requested / granted is the internal fragmentation
+     */
+    std::size_t requested;
+    std::size_t granted;
+    /**
+     * @brief fill[k] counts allocations that used from k / Bins
+     *        (exclusive) to (k + 1) / Bins (inclusive) of the block
+     */
+    std::array<std::size_t, Bins> fill;
+    
+    constexpr auto on_allocate (
+        std::size_t nT, std::size_t block_size, std::size_t count = 1u
+    ) noexcept -> void {
+        live += count;
+        if (live > peak) {
+            peak = live;
+        }
+        requested += nT * count;
+        granted += block_size * count;
+        fill[(nT * Bins - 1u) / block_size] += count;
+    }
+    
+    constexpr auto on_failure () noexcept -> void {
+        ++failures;
+    }
+    
+    constexpr auto on_deallocate (std::size_t count = 1u) noexcept -> void {
+        live -= count;
+    }
+};
+
+struct disabled {
+    constexpr static auto is_enabled = false;
+    
+    template <std::size_t N>
+    struct table {};
+};
+
+template <std::size_t Bins = 8u>
+struct enabled {
+    static_assert(Bins != 0u);
+    
+    constexpr static auto is_enabled = true;
+    
+    template <std::size_t N>
+    using table = std::array<record<Bins>, N>;
+};
+
+template <typename Stats, typename SequenceContainer>
+[[nodiscard]]
+constexpr static auto table_size () noexcept -> std::size_t {
+    if constexpr (Stats::is_enabled) {
+        return std::tuple_size_v<SequenceContainer>;
+    } else {
+        return 0u;
+    }
+}
+
+}
+
+/**
+ * @brief
+ * @tparam T
+ * @tparam SequenceContainer -- any SequenceContainer class.
+ * @tparam Container -- reference to SequenceContainer,
+ *         the pointers inside must satisfy two requirements:
+ *         -- they are ascending-sorted by storage's block_size
+ *         -- every block_size must be unique (blocks_count can be the same)
+ *         i.e. sort them by Container[i]->block_size()
+ *         storages of different kinds ('storage', 'bitmap_storage') can be
+ *         mixed in the same container
+ * @tparam Stats -- stats::disabled or stats::enabled<...>, the latter
+ *         requires a fixed size SequenceContainer (std::array)
+ */
+template <
+    typename T,
+    typename SequenceContainer,
+    SequenceContainer& Container,
+    typename Stats = stats::disabled
+>
+class allocator {
+    static_assert(!std::is_void_v<T>);
+    static_assert(
+        std::is_same_v<
+            typename SequenceContainer::value_type,
+            storage_base<T>*
+        >
+    );
+
+public:
+    using stats_table_t = typename Stats::template table<
+        stats::table_size<Stats, SequenceContainer>()
+    >;
+
+public:
+    constexpr allocator () noexcept = default;
+
+public:
+    [[nodiscard]]
+    auto allocate (std::size_t nT) noexcept -> T* {
+        auto i = _search_fitting_container(nT); ///< O(logn)
+        if (_container_index_out_of_bounds(i)) { ///< O(1)
+            return nullptr;
+        }
+        auto p = Container[i]->allocate_block(); ///< depends on the storage
+        if constexpr (Stats::is_enabled) {
+            if (p != nullptr) {
+                _stats[i].on_allocate(nT, Container[i]->block_size());
             } else {
-                return im;     /// exact pointer value match
+                _stats[i].on_failure();
             }
         }
-        
-        return _blocks_count; /// return 'past the end'
+        return p;
+    }
+    
+    auto deallocate (T* p, std::size_t nT) noexcept -> void {
+        auto i = _search_fitting_container(nT); ///< O(logn)
+        /// a wrong size must not leak the block, look for it by the address
+        if (_container_index_out_of_bounds(i) ||
+            !Container[i]->owns(p)) { ///< O(1)
+            deallocate(p);
+            return;
+        }
+        _deallocate_block(i, p);
     }
     
+    /**
+     * @brief Resize the block 'p' of 'old_nT' Ts to 'new_nT' Ts.
+     *        If 'p' is a block of the storage that serves 'new_nT' it is
+     *        returned as it is. Otherwise the first min(old_nT, new_nT) Ts are
+     *        copied once into a block of the new size and 'p' is deallocated.
+     *        nullptr 'p' is just allocated.
+     * @return nullptr if there is no block for 'new_nT' (e.g. it's 0),
+     *         'p' stays allocated then
+     */
     [[nodiscard]]
-    auto _index_out_of_bounds (std::size_t i) noexcept -> bool {
-        return i >= _blocks_count;
+    auto reallocate (T* p, std::size_t old_nT, std::size_t new_nT) noexcept
+    -> T* {
+        if (p == nullptr) {
+            return allocate(new_nT);
+        }
+        auto i = _search_fitting_container(new_nT); ///< O(logn)
+        if (!_container_index_out_of_bounds(i) &&
+            Container[i]->owns(p)) { ///< O(1)
+            return p;
+        }
+        auto q = allocate(new_nT);
+        if (q == nullptr) {
+            return nullptr;
+        }
+        std::copy_n(p, std::min(old_nT, new_nT), q);
+        deallocate(p, old_nT);
+        return q;
+    }
+    
+    /**
+     * @brief Allocate 'count' blocks of the same size at once, the storage
+     *        is searched for only once
+     * @return number of blocks written to 'out', less than 'count' if the
+     *         storage ran out of free blocks
+     */
+    [[nodiscard]]
+    auto allocate_n (std::size_t nT, std::size_t count, T** out) noexcept
+    -> std::size_t {
+        auto i = _search_fitting_container(nT); ///< O(logn)
+        if (_container_index_out_of_bounds(i)) { ///< O(1)
+            return 0u;
+        }
+        auto n = Container[i]->allocate_blocks(out, count);
+        if constexpr (Stats::is_enabled) {
+            if (n != 0u) {
+                _stats[i].on_allocate(nT, Container[i]->block_size(), n);
+            }
+            if (n != count) {
+                _stats[i].on_failure();
+            }
+        }
+        return n;
+    }
+    
+    /**
+     * @brief Give back 'count' blocks of the same size at once, blocks that
+     *        the storage of 'nT' doesn't own are looked for by the address
+     */
+    auto deallocate_n (T* const* ps, std::size_t count, std::size_t nT)
+    noexcept -> void {
+        auto i = _search_fitting_container(nT); ///< O(logn)
+        /// a wrong size must not leak the blocks
+        if (_container_index_out_of_bounds(i)) { ///< O(1)
+            for (auto k : range::range(count)) {
+                deallocate(ps[k]);
+            }
+            return;
+        }
+        if constexpr (Stats::is_enabled) {
+            /// counted one by one, a block may come twice in a batch
+            for (auto k : range::range(count)) {
+                if (!Container[i]->owns(ps[k])) { ///< O(1)
+                    deallocate(ps[k]);
+                } else {
+                    _deallocate_block(i, ps[k]);
+                }
+            }
+        } else {
+            _implementation::deallocate_owned_blocks(
+                *Container[i], ps, count, [this] (T* p) { deallocate(p); }
+            );
+        }
+    }
+    
+    /**
+     * @brief Same as above, but the storage is found by the pool that holds
+     *        'p' instead of the size, so the size is not needed.
+     *        Pointers that are not blocks of any storage are ignored, debug
+     *        builds (no NDEBUG) trap on them.
+     */
+    auto deallocate (T* p) noexcept -> void {
+        if (p == nullptr) {
+            return;
+        }
+        auto i = _implementation::search_owning_container<
+            T, SequenceContainer, Container
+        >(p); ///< O(logn)
+        if (_container_index_out_of_bounds(i) || !Container[i]->owns(p)) {
+            _implementation::foreign_pointer();
+            return;
+        }
+        _deallocate_block(i, p);
+    }
+    
+    /**
+     * @return stats records, one per storage in the same order as in the
+     *         Container (empty if the stats are disabled)
+     */
+    [[nodiscard]]
+    static auto stats () noexcept -> const stats_table_t& {
+        return _stats;
+    }
+
+private:
+    static inline stats_table_t _stats {};
+
+private:
+    [[nodiscard]]
+    auto _search_fitting_container (std::size_t nT) noexcept -> std::size_t {
+        return _implementation::search_fitting_container(Container, nT);
+    }
+    
+    [[nodiscard]]
+    auto _container_index_out_of_bounds (std::size_t i) const noexcept ->
+    bool {
+        return i >= Container.size();
+    }
+    
+    auto _deallocate_block (std::size_t i, T* p) noexcept -> void {
+        if constexpr (Stats::is_enabled) {
+            /// a double free must not be counted
+            if (Container[i]->is_allocated(p)) {
+                _stats[i].on_deallocate();
+            }
+        }
+        Container[i]->deallocate_block(p); ///< depends on the storage
     }
     
 };
+
+/**
+ * @brief Same as 'allocator', but bound directly to the storages instances
+ *        instead of the array of pointers to their virtual base.
+ *        Storage is chosen by a fold expression over the compile-time block
+ *        sizes and its methods are called on the concrete (final) type, so no
+ *        virtual call happens neither in allocation nor in deallocation.
+ *
+ *        Usage:
+ *        static auto s0 = storage<char, 2, 1024>();
+ *        static auto s1 = bitmap_storage<char, 11, 500>();
+ *        using alloc = direct_allocator<char, s0, s1>;
+ *
+ * @tparam T
+ * @tparam Stats -- same as for 'allocator'
+ * @tparam Storages -- references to storages with static storage duration,
+ *         ascending-sorted by their block sizes, every block size is unique
+ */
+template <
+    typename T,
+    typename Stats,
+    auto&...Storages
+>
+class basic_direct_allocator {
+    static_assert(!std::is_void_v<T>);
+    static_assert(sizeof...(Storages) != 0);
+    static_assert(
+        (std::is_base_of_v<
+            storage_base<T>, std::remove_reference_t<decltype(Storages)>
+        > && ...)
+    );
+    
+    template <auto& S>
+    constexpr static auto _block_size_of =
+        std::remove_reference_t<decltype(S)>::block_size_v;
+    
+    static_assert(
+        sequence::is_strictly_sorted(_block_size_of<Storages>...),
+        "storages must be ascending-sorted by unique block sizes"
+    );
+
+public:
+    using stats_table_t = typename Stats::template table<
+        Stats::is_enabled ? sizeof...(Storages) : 0u
+    >;
+
+public:
+    constexpr basic_direct_allocator () noexcept = default;
+
+public:
+    [[nodiscard]]
+    auto allocate (std::size_t nT) noexcept -> T* {
+        T* p = nullptr;
+        auto i = std::size_t(0u); ///< index of the storage, if stats need it
+        /// first fitting storage wins, the rest of the fold is skipped
+        (void)((_fits<Storages>(nT) ?
+                (p = Storages.allocate_block(), true) : (++i, false)) || ...);
+        if constexpr (Stats::is_enabled) {
+            if (i == sizeof...(Storages)) {
+                return p;
+            }
+            if (p != nullptr) {
+                _stats[i].on_allocate(nT, _block_sizes[i]);
+            } else {
+                _stats[i].on_failure();
+            }
+        }
+        return p;
+    }
+    
+    auto deallocate (T* p, std::size_t nT) noexcept -> void {
+        auto i = std::size_t(0u);
+        auto done = ((_fits<Storages>(nT) && Storages.owns(p) ?
+                      (_stats_on_deallocate<Storages>(i, p),
+                       Storages.deallocate_block(p), true) :
+                      (++i, false)) || ...);
+        if (!done) { ///< a wrong size must not leak the block
+            deallocate(p);
+        }
+    }
+    
+    /**
+     * @brief Pointers that are not blocks of any storage are ignored,
+     *        debug builds (no NDEBUG) trap on them
+     */
+    auto deallocate (T* p) noexcept -> void {
+        if (p == nullptr) {
+            return;
+        }
+        auto i = std::size_t(0u);
+        auto done = ((Storages.owns(p) ?
+                      (_stats_on_deallocate<Storages>(i, p),
+                       Storages.deallocate_block(p), true) :
+                      (++i, false)) || ...);
+        if (!done) {
+            _implementation::foreign_pointer();
+        }
+    }
+    
+    /**
+     * @brief Resize the block 'p' of 'old_nT' Ts to 'new_nT' Ts.
+     *        If 'p' is a block of the storage that serves 'new_nT' it is
+     *        returned as it is. Otherwise the first min(old_nT, new_nT) Ts are
+     *        copied once into a block of the new size and 'p' is deallocated.
+     *        nullptr 'p' is just allocated.
+     * @return nullptr if there is no block for 'new_nT' (e.g. it's 0),
+     *         'p' stays allocated then
+     */
+    [[nodiscard]]
+    auto reallocate (T* p, std::size_t old_nT, std::size_t new_nT) noexcept
+    -> T* {
+        if (p == nullptr) {
+            return allocate(new_nT);
+        }
+        auto in_place = false;
+        (void)((_fits<Storages>(new_nT) ?
+                (in_place = Storages.owns(p), true) : false) || ...);
+        if (in_place) {
+            return p;
+        }
+        auto q = allocate(new_nT);
+        if (q == nullptr) {
+            return nullptr;
+        }
+        std::copy_n(p, std::min(old_nT, new_nT), q);
+        deallocate(p, old_nT);
+        return q;
+    }
+    
+    [[nodiscard]]
+    auto allocate_n (std::size_t nT, std::size_t count, T** out) noexcept
+    -> std::size_t {
+        auto n = std::size_t(0u);
+        auto i = std::size_t(0u);
+        (void)((_fits<Storages>(nT) ?
+                (n = Storages.allocate_blocks(out, count), true) :
+                (++i, false)) || ...);
+        if constexpr (Stats::is_enabled) {
+            if (i == sizeof...(Storages)) {
+                return n;
+            }
+            if (n != 0u) {
+                _stats[i].on_allocate(nT, _block_sizes[i], n);
+            }
+            if (n != count) {
+                _stats[i].on_failure();
+            }
+        }
+        return n;
+    }
+    
+    auto deallocate_n (T* const* ps, std::size_t count, std::size_t nT)
+    noexcept -> void {
+        auto i = std::size_t(0u);
+        auto done = ((_fits<Storages>(nT) ?
+                      (_deallocate_n_to<Storages>(i, ps, count), true) :
+                      (++i, false)) || ...);
+        if (!done) { ///< a wrong size must not leak the blocks
+            for (auto k : range::range(count)) {
+                deallocate(ps[k]);
+            }
+        }
+    }
+    
+    /**
+     * @return stats records, one per storage in the same order as in the
+     *         Storages (empty if the stats are disabled)
+     */
+    [[nodiscard]]
+    static auto stats () noexcept -> const stats_table_t& {
+        return _stats;
+    }
+
+private:
+    static inline stats_table_t _stats {};
+    
+    constexpr static std::array<std::size_t, sizeof...(Storages)>
+    _block_sizes { _block_size_of<Storages>... };
+
+private:
+    template <auto& S>
+    static auto _stats_on_deallocate (std::size_t i, const T* p) noexcept
+    -> void {
+        if constexpr (Stats::is_enabled) {
+            /// a double free must not be counted
+            if (S.is_allocated(p)) {
+                _stats[i].on_deallocate();
+            }
+        }
+    }
+    
+    /**
+     * @brief Blocks that 'S' doesn't own are looked for by the address
+     */
+    template <auto& S>
+    auto _deallocate_n_to (std::size_t i, T* const* ps, std::size_t count)
+    noexcept -> void {
+        if constexpr (Stats::is_enabled) {
+            /// counted one by one, a block may come twice in a batch
+            for (auto k : range::range(count)) {
+                if (!S.owns(ps[k])) {
+                    deallocate(ps[k]);
+                } else {
+                    _stats_on_deallocate<S>(i, ps[k]);
+                    S.deallocate_block(ps[k]);
+                }
+            }
+        } else {
+            _implementation::deallocate_owned_blocks(
+                S, ps, count, [this] (T* p) { deallocate(p); }
+            );
+        }
+    }
+
+private:
+    template <auto& S>
+    [[nodiscard]]
+    constexpr static auto _fits (std::size_t nT) noexcept -> bool {
+        return (nT != 0u) && (nT <= _block_size_of<S>);
+    }
+};
+
+template <
+    typename T,
+    auto&...Storages
+>
+using direct_allocator = basic_direct_allocator<
+    T, stats::disabled, Storages...
+>;
     
 }
     
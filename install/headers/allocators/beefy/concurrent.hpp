@@ -0,0 +1,253 @@
+/** @file concurrent.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Thread-safe front-end for the beefy storages.
+ *
+ * @details
+ *
+ *        Storages are not synchronized, so every storage in the container
+ *        gets its own lock. To keep threads from fighting over those locks
+ *        every thread has a small cache ('magazine') of free blocks per
+ *        storage:
+ *        - allocation pops a block from the magazine, an empty magazine is
+ *          refilled with half of its capacity under the storage lock
+ *        - deallocation pushes the block into the magazine of the calling
+ *          thread (no matter which thread allocated it), a full magazine
+ *          gives half of its blocks back under the storage lock
+ *        - magazines are given back to the storages when the thread exits
+ *
+ *        So the locks are taken once per MagazineSize / 2 operations at most.
+ *        A block that is still in the magazine of the calling thread is not
+ *        cached again (hardened mode traps on it). That is the only double
+ *        free caught here: a block freed again after it left the magazine
+ *        (flush(), a full magazine, thread exit) or freed by two threads is
+ *        cached anyway and gets handed out twice.
+ *        The price is that blocks cached by one thread can't be used by
+ *        another, allocation may fail while some blocks are sitting in
+ *        someone else's magazine. Call flush() from a thread that is about to
+ *        go idle to give its blocks back.
+ *
+ *        The storages must not be used through any other allocator at the
+ *        same time.
+ *
+ * Usage example:
+ *
+ * static auto s0 = storage<char, 16, 4096>();
+ * static auto s1 = bitmap_storage<char, 256, 1024>();
+ * static auto storage = make_ptrs_to_storages_array<char>(s0, s1);
+ *
+ * using alloc = concurrent_allocator<char, decltype(storage), storage>;
+ * /// any thread
+ * auto p = alloc().allocate(100);
+ * alloc().deallocate(p, 100);
+ */
+
+#ifndef KCPPT_ALLOCATORS_BEEFY_CONCURRENT_HPP
+#define KCPPT_ALLOCATORS_BEEFY_CONCURRENT_HPP
+
+#include "../beefy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <tuple>
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace beefy {
+
+/**
+ * @tparam T
+ * @tparam SequenceContainer -- fixed size container (std::array), the
+ *         number of storages must be known at compile time
+ * @tparam Container -- same requirements as for 'allocator'
+ * @tparam MagazineSize -- number of blocks cached per thread per storage
+ */
+template <
+    typename T,
+    typename SequenceContainer,
+    SequenceContainer& Container,
+    std::size_t MagazineSize = 16u
+>
+class concurrent_allocator {
+    static_assert(!std::is_void_v<T>);
+    static_assert(
+        std::is_same_v<
+            typename SequenceContainer::value_type,
+            storage_base<T>*
+        >
+    );
+    static_assert(MagazineSize >= 2u);
+
+private:
+    constexpr static auto _storages_count =
+        std::tuple_size_v<SequenceContainer>;
+    
+    constexpr static auto _batch_size = MagazineSize / 2u;
+    
+    struct magazine {
+        std::size_t size;
+        std::array<T*, MagazineSize> blocks;
+    };
+    
+    struct magazines {
+        std::array<magazine, _storages_count> m;
+        
+        ~magazines () noexcept {
+            flush_all(*this);
+        }
+    };
+
+public:
+    constexpr concurrent_allocator () noexcept = default;
+
+public:
+    [[nodiscard]]
+    auto allocate (std::size_t nT) noexcept -> T* {
+        auto i = _implementation::search_fitting_container(Container, nT);
+        if (i >= _storages_count) {
+            return nullptr;
+        }
+        
+        auto& mag = _local().m[i];
+        if (mag.size == 0u) {
+            _refill(i, mag); ///< locked, once per _batch_size calls at most
+        }
+        if (mag.size == 0u) {
+            return nullptr;
+        }
+        return mag.blocks[--mag.size];
+    }
+    
+    auto deallocate (T* p, std::size_t nT) noexcept -> void {
+        auto i = _implementation::search_fitting_container(Container, nT);
+        /// a wrong size must not leak the block, look for it by the address
+        if ((i >= _storages_count) || !Container[i]->owns(p)) {
+            deallocate(p);
+            return;
+        }
+        _put(i, p);
+    }
+    
+    /**
+     * @brief Pointers that are not blocks of any storage are ignored,
+     *        debug builds (no NDEBUG) trap on them
+     */
+    auto deallocate (T* p) noexcept -> void {
+        if (p == nullptr) {
+            return;
+        }
+        auto i = _implementation::search_owning_container<
+            T, SequenceContainer, Container
+        >(p); ///< O(logn)
+        if ((i >= _storages_count) || !Container[i]->owns(p)) {
+            _implementation::foreign_pointer();
+            return;
+        }
+        _put(i, p);
+    }
+    
+    /**
+     * @brief Give every block cached by the calling thread back to the
+     *        storages
+     */
+    static auto flush () noexcept -> void {
+        flush_all(_local());
+    }
+
+private:
+    [[nodiscard]]
+    static auto _local () noexcept -> magazines& {
+        thread_local magazines mags {};
+        return mags;
+    }
+    
+    [[nodiscard]]
+    static auto _lock (std::size_t i) noexcept -> std::mutex& {
+        static std::array<std::mutex, _storages_count> locks;
+        return locks[i];
+    }
+    
+    static auto flush_all (magazines& mags) noexcept -> void {
+        for (auto i : range::range(_storages_count)) {
+            _drain(i, mags.m[i], mags.m[i].size);
+        }
+    }
+    
+    static auto _put (std::size_t i, T* p) noexcept -> void {
+        /// foreign pointers must not get into the magazines
+        if (!Container[i]->owns(p)) {
+            return;
+        }
+        auto& mag = _local().m[i];
+        auto cached = mag.blocks.begin() + mag.size;
+        if (std::find(mag.blocks.begin(), cached, p) != cached) {
+            if constexpr (_implementation::hardened) {
+                _implementation::hardened_trap(
+                    "the block is already free (double free)"
+                );
+            }
+            return;
+        }
+        if (mag.size == MagazineSize) {
+            _drain(i, mag, _batch_size); ///< locked
+        }
+        mag.blocks[mag.size++] = p;
+    }
+    
+    static auto _refill (std::size_t i, magazine& mag) noexcept -> void {
+        std::lock_guard<std::mutex> guard(_lock(i));
+        mag.size += Container[i]->allocate_blocks(
+            mag.blocks.data() + mag.size, _batch_size - mag.size
+        );
+    }
+    
+    /**
+     * @brief Give 'count' most recently cached blocks back to the storage
+     */
+    static auto _drain (
+        std::size_t i, magazine& mag, std::size_t count
+    ) noexcept -> void {
+        if (count == 0u) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(_lock(i));
+        mag.size -= count;
+        Container[i]->deallocate_blocks(mag.blocks.data() + mag.size, count);
+    }
+};
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_ALLOCATORS_BEEFY_CONCURRENT_HPP
@@ -0,0 +1,359 @@
+/** @file lockfree.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Lock-free fixed-size block pool, any thread can allocate and any
+ *         other thread can deallocate.
+ *
+ * @details
+ *
+ *        The pool has the same layout as the one of the beefy 'storage'.
+ *        Free blocks form a stack (Treiber stack) linked by their indices,
+ *        the link of every block is kept in a separate array so that the
+ *        pool memory is never touched by the storage.
+ *        The top of the stack is a single atomic word that holds the index
+ *        of the top block in the lower half and a tag in the upper half. The
+ *        tag is incremented on every push and pop, so a thread that read a
+ *        stale top (the ABA problem) fails its CAS and retries.
+ *
+ *        Both allocation and deallocation are a single CAS when there is no
+ *        contention.
+ *
+ *        The tagged word is 64 bits wide if the platform has lock-free 64-bit
+ *        atomics (up to 2^32 - 1 blocks), 32 bits wide otherwise (up to
+ *        2^16 - 1 blocks, the tag wraps faster).
+ *
+ *        Every block also has an allocated flag, set when the block is
+ *        popped and cleared when it is pushed back. A block whose flag is
+ *        already clear is not pushed, so a double free is ignored instead of
+ *        linking the block to itself.
+ *
+ *        Overhead is one index and one flag per block (5 or 3 bytes).
+ *
+ *        It implements 'storage_base', so it can be put into the containers
+ *        of the beefy allocators. The allocators hold no state of their own,
+ *        a container of lock-free storages only makes a thread-safe
+ *        'allocator' or 'direct_allocator'.
+ *
+ * Usage example:
+ *
+ * static auto pool = lockfree_storage<message, 1, 1024>();
+ * /// producer
+ * auto m = pool.allocate_block();
+ * /// consumer
+ * pool.deallocate_block(m);
+ */
+
+#ifndef KCPPT_ALLOCATORS_BEEFY_LOCKFREE_HPP
+#define KCPPT_ALLOCATORS_BEEFY_LOCKFREE_HPP
+
+#include "../beefy.hpp"
+
+#include <atomic>
+#include <limits>
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace beefy {
+
+namespace _implementation {
+
+/**
+ * @brief Tag in the upper half, index in the lower half
+ */
+using tagged_index_t = std::conditional_t<
+    std::atomic<std::uint64_t>::is_always_lock_free,
+    std::uint64_t,
+    std::uint32_t
+>;
+
+using half_index_t = std::conditional_t<
+    std::is_same_v<tagged_index_t, std::uint64_t>,
+    std::uint32_t,
+    std::uint16_t
+>;
+
+}
+
+template <typename T, std::size_t TBlockSize, std::size_t TBlocksCount>
+class lockfree_storage final : public storage_base<T> {
+    static_assert(!std::is_void_v<T>);
+    static_assert(TBlockSize != 0);
+    static_assert(TBlocksCount != 0);
+    static_assert(
+        std::atomic<_implementation::tagged_index_t>::is_always_lock_free
+    );
+
+public:
+    constexpr static auto block_size_v = TBlockSize;
+    constexpr static auto blocks_count_v = TBlocksCount;
+
+private:
+    using tagged_t = _implementation::tagged_index_t;
+    using index_t = _implementation::half_index_t;
+    
+    constexpr static auto _index_width = sizeof(index_t) * CHAR_BIT;
+    /**
+     * @brief 'no block' index, marks the bottom of the stack
+     */
+    constexpr static auto _nil = std::numeric_limits<index_t>::max();
+    
+    static_assert(TBlocksCount < _nil, "too many blocks for the tagged index");
+
+private:
+    alignas(_implementation::cache_line_size)
+    T _pool_of_T[TBlockSize * TBlocksCount];
+    /**
+     * @brief index of the next free block for every free block
+     */
+    alignas(_implementation::cache_line_size)
+    std::array<std::atomic<index_t>, TBlocksCount> _next;
+    /**
+     * @brief true for every allocated block
+     */
+    alignas(_implementation::cache_line_size)
+    std::array<std::atomic<bool>, TBlocksCount> _allocated;
+    /**
+     * @brief tagged index of the top free block, the only contended word,
+     *        so it gets a cache line of its own
+     */
+    alignas(_implementation::cache_line_size)
+    std::atomic<tagged_t> _top;
+
+public:
+    lockfree_storage () noexcept :
+        _pool_of_T(),
+        _next(),
+        _allocated(),
+        _top(_pack(0u, 0u))
+    {
+        for (auto i : range::range(TBlocksCount - 1u)) {
+            _next[i].store(index_t(i + 1u), std::memory_order_relaxed);
+        }
+        for (auto& a : _allocated) {
+            a.store(false, std::memory_order_relaxed);
+        }
+        _next[TBlocksCount - 1u].store(_nil, std::memory_order_relaxed);
+    }
+    
+    ~lockfree_storage () = default;
+
+public:
+    [[nodiscard]]
+    virtual auto block_size () const noexcept -> std::size_t final {
+        return TBlockSize;
+    }
+    
+    [[nodiscard]]
+    virtual auto blocks_count () const noexcept -> std::size_t final {
+        return TBlocksCount;
+    }
+    
+    [[nodiscard]]
+    virtual auto allocate_block () noexcept -> T* final {
+        auto top = _top.load(std::memory_order_acquire);
+        while (true) {
+            auto i = _index(top);
+            if (i == _nil) {
+                return nullptr;
+            }
+            /// may be stale if 'i' was taken meanwhile, then the CAS fails
+            auto next = _next[i].load(std::memory_order_relaxed);
+            if (_top.compare_exchange_weak(
+                top, _pack(next, _tag(top) + 1u),
+                std::memory_order_acquire, std::memory_order_acquire
+            )) {
+                _allocated[i].store(true, std::memory_order_relaxed);
+                return _pool_of_T + i * TBlockSize;
+            }
+        }
+    }
+    
+    virtual auto deallocate_block (T* p) noexcept -> void final {
+        auto i = _implementation::pool_index(
+            _pool_of_T, TBlockSize, TBlocksCount, p
+        );
+        if (i == TBlocksCount) {
+            return;
+        }
+        if (!_release_flag(i)) { ///< double free
+            return;
+        }
+        auto top = _top.load(std::memory_order_relaxed);
+        do {
+            _next[i].store(_index(top), std::memory_order_relaxed);
+        } while (!_top.compare_exchange_weak(
+            top, _pack(index_t(i), _tag(top) + 1u),
+            std::memory_order_release, std::memory_order_relaxed
+        ));
+    }
+    
+    /**
+     * @brief The whole chain of 'count' blocks is popped with a single CAS
+     */
+    [[nodiscard]]
+    virtual auto allocate_blocks (T** out, std::size_t count) noexcept
+    -> std::size_t final {
+        if (count == 0u) {
+            return 0u;
+        }
+        auto top = _top.load(std::memory_order_acquire);
+        while (true) {
+            auto n = std::size_t(0u);
+            auto i = _index(top);
+            /// the links may be stale, then the tag has changed and CAS fails
+            while ((i != _nil) && (n != count)) {
+                out[n++] = _pool_of_T + i * TBlockSize;
+                i = _next[i].load(std::memory_order_relaxed);
+            }
+            if (n == 0u) {
+                return 0u;
+            }
+            if (_top.compare_exchange_weak(
+                top, _pack(i, _tag(top) + 1u),
+                std::memory_order_acquire, std::memory_order_acquire
+            )) {
+                for (auto k : range::range(n)) {
+                    _allocated[_index_of(out[k])].store(
+                        true, std::memory_order_relaxed
+                    );
+                }
+                return n;
+            }
+        }
+    }
+    
+    /**
+     * @brief Blocks are linked together first, then pushed with a single CAS
+     */
+    virtual auto deallocate_blocks (T* const* ps, std::size_t count) noexcept
+    -> void final {
+        auto first = _nil;
+        auto last = _nil;
+        for (auto k : range::range(count)) {
+            auto i = _implementation::pool_index(
+                _pool_of_T, TBlockSize, TBlocksCount, ps[k]
+            );
+            if ((i == TBlocksCount) || !_release_flag(i)) {
+                continue;
+            }
+            if (first == _nil) {
+                last = index_t(i);
+            } else {
+                _next[i].store(first, std::memory_order_relaxed);
+            }
+            first = index_t(i);
+        }
+        if (first == _nil) {
+            return;
+        }
+        auto top = _top.load(std::memory_order_relaxed);
+        do {
+            _next[last].store(_index(top), std::memory_order_relaxed);
+        } while (!_top.compare_exchange_weak(
+            top, _pack(first, _tag(top) + 1u),
+            std::memory_order_release, std::memory_order_relaxed
+        ));
+    }
+    
+    [[nodiscard]]
+    virtual auto owns (const T* p) const noexcept -> bool final {
+        return _implementation::pool_index(
+            _pool_of_T, TBlockSize, TBlocksCount, p
+        ) != TBlocksCount;
+    }
+    
+    /**
+     * @brief A snapshot, other threads may change it right away
+     */
+    [[nodiscard]]
+    virtual auto is_allocated (const T* p) const noexcept -> bool final {
+        auto i = _implementation::pool_index(
+            _pool_of_T, TBlockSize, TBlocksCount, p
+        );
+        return (i != TBlocksCount) &&
+               _allocated[i].load(std::memory_order_relaxed);
+    }
+    
+    [[nodiscard]]
+    virtual auto block_of (const T* p) noexcept -> T* final {
+        return _implementation::pool_block(
+            _pool_of_T, TBlockSize, TBlocksCount, p
+        );
+    }
+    
+    [[nodiscard]]
+    virtual auto pool_begin () const noexcept -> const T* final {
+        return _pool_of_T;
+    }
+    
+    [[nodiscard]]
+    virtual auto pool_end () const noexcept -> const T* final {
+        return _pool_of_T + TBlockSize * TBlocksCount;
+    }
+
+private:
+    /**
+     * @brief Clear the allocated flag of the block
+     * @return false if it was already clear
+     */
+    [[nodiscard]]
+    auto _release_flag (std::size_t i) noexcept -> bool {
+        return _allocated[i].exchange(false, std::memory_order_relaxed);
+    }
+    
+    [[nodiscard]]
+    auto _index_of (const T* p) const noexcept -> std::size_t {
+        return static_cast<std::size_t>(p - _pool_of_T) / TBlockSize;
+    }
+    
+    [[nodiscard]]
+    constexpr static auto _pack (index_t i, tagged_t tag) noexcept
+    -> tagged_t {
+        return (tag << _index_width) | i;
+    }
+    
+    [[nodiscard]]
+    constexpr static auto _index (tagged_t t) noexcept -> index_t {
+        return static_cast<index_t>(t);
+    }
+    
+    [[nodiscard]]
+    constexpr static auto _tag (tagged_t t) noexcept -> tagged_t {
+        return t >> _index_width;
+    }
+};
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_ALLOCATORS_BEEFY_LOCKFREE_HPP
@@ -0,0 +1,418 @@
+/** @file mapped_storage.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Runtime-sized beefy storage, the pool is mapped with mmap instead
+ *         of being a part of the object.
+ *
+ * @details
+ *
+ *        Block size and blocks count are constructor arguments, so the pools
+ *        can be sized from a configuration at startup and don't take any
+ *        space in the executable image.
+ *
+ *        Free blocks are tracked with the same two-level bitmap as in
+ *        'bitmap_storage', kept in a separate small mapping.
+ *
+ *        The pool can be backed by huge pages to cut TLB misses on large
+ *        pools:
+ *        - pages::normal -- regular pages
+ *        - pages::transparent -- the pool is aligned to a huge page and
+ *          advised (MADV_HUGEPAGE) to the transparent huge pages
+ *        - pages::huge -- explicit huge pages (MAP_HUGETLB), they have to be
+ *          reserved in the system. If that fails, falls back to
+ *          pages::transparent.
+ *        pages() tells what was actually used.
+ *
+ *        The mapping may fail, check valid() after the construction. An
+ *        invalid storage has no blocks, allocation always fails.
+ *
+ *        Only available where <sys/mman.h> is.
+ *
+ * Usage example:
+ *
+ * static auto s0 = mapped_storage<char>(64, config.small_blocks);
+ * static auto s1 = mapped_storage<char>(4096, config.large_blocks, pages::huge);
+ * static auto storage = make_ptrs_to_storages_array<char>(s0, s1);
+ *
+ * using alloc = allocator<char, decltype(storage), storage>;
+ */
+
+#ifndef KCPPT_ALLOCATORS_BEEFY_MAPPED_STORAGE_HPP
+#define KCPPT_ALLOCATORS_BEEFY_MAPPED_STORAGE_HPP
+
+#include "../beefy.hpp"
+
+#if __has_include(<sys/mman.h>)
+
+#include <cstdint>
+
+#include <sys/mman.h>
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace beefy {
+
+enum class pages {
+    normal,
+    transparent,
+    huge
+};
+
+namespace _implementation {
+
+/**
+ * @brief Default huge page size of x86-64 and most ARM64 systems
+ */
+constexpr static std::size_t huge_page_size = std::size_t(2u) << 20u;
+
+[[nodiscard]]
+constexpr static auto round_up (std::size_t n, std::size_t to) noexcept
+-> std::size_t {
+    return (n + to - 1u) / to * to;
+}
+
+/**
+ * @return nullptr on failure
+ */
+[[nodiscard]]
+static auto map_anonymous (std::size_t size, int extra_flags = 0) noexcept
+-> void* {
+    auto p = ::mmap(
+        nullptr, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0
+    );
+    return (p == MAP_FAILED) ? nullptr : p;
+}
+
+/**
+ * @brief Map 'size' bytes aligned to 'alignment' by mapping more and
+ *        unmapping the excess at both ends
+ * @return nullptr on failure
+ */
+[[nodiscard]]
+static auto map_aligned (std::size_t size, std::size_t alignment) noexcept
+-> void* {
+    auto raw = map_anonymous(size + alignment);
+    if (raw == nullptr) {
+        return nullptr;
+    }
+    auto begin = reinterpret_cast<std::uintptr_t>(raw);
+    auto aligned = (begin + alignment - 1u) / alignment * alignment;
+    if (aligned != begin) {
+        ::munmap(raw, aligned - begin);
+    }
+    auto tail = begin + size + alignment - (aligned + size);
+    if (tail != 0u) {
+        ::munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+}
+
+template <typename T>
+class mapped_storage final : public storage_base<T> {
+    static_assert(!std::is_void_v<T>);
+
+private:
+    using word_t = _implementation::bitmap_word_t;
+
+private:
+    std::size_t _block_size;
+    std::size_t _blocks_count;
+    beefy::pages _pages;
+    
+    T* _pool_of_T;
+    std::size_t _pool_bytes;
+    /**
+     * @brief _free_bits and _free_words share a single mapping
+     */
+    word_t* _free_bits;
+    word_t* _free_words;
+    std::size_t _control_bytes;
+
+public:
+    /**
+     * @param block_size -- in Ts, not 0
+     * @param blocks_count -- not 0
+     * @param pages -- preferred pages of the pool
+     */
+    mapped_storage (
+        std::size_t block_size, std::size_t blocks_count,
+        beefy::pages pages = beefy::pages::normal
+    ) noexcept :
+        _block_size(block_size),
+        _blocks_count(blocks_count),
+        _pages(pages),
+        _pool_of_T(nullptr),
+        _pool_bytes(0u),
+        _free_bits(nullptr),
+        _free_words(nullptr),
+        _control_bytes(0u)
+    {
+        if ((block_size == 0u) || (blocks_count == 0u) ||
+            (block_size > SIZE_MAX / sizeof(T) / blocks_count)) {
+            _blocks_count = 0u;
+            return;
+        }
+        _map_pool(block_size * blocks_count * sizeof(T));
+        _map_control();
+        if ((_pool_of_T == nullptr) || (_free_bits == nullptr)) {
+            _unmap();
+            _blocks_count = 0u;
+        }
+    }
+    
+    mapped_storage (const mapped_storage&) = delete;
+    auto operator= (const mapped_storage&) -> mapped_storage& = delete;
+    
+    ~mapped_storage () noexcept {
+        _unmap();
+    }
+
+public:
+    /**
+     * @return false if the pool could not be mapped
+     */
+    [[nodiscard]]
+    auto valid () const noexcept -> bool {
+        return _pool_of_T != nullptr;
+    }
+    
+    /**
+     * @return pages that actually back the pool
+     */
+    [[nodiscard]]
+    auto pages () const noexcept -> beefy::pages {
+        return _pages;
+    }
+    
+    /**
+     * @return the mapping of the pool, e.g. to set its memory policy
+     *         before the pages are touched. nullptr if the storage is not
+     *         valid
+     */
+    [[nodiscard]]
+    auto pool () noexcept -> T* {
+        return _pool_of_T;
+    }
+    
+    /**
+     * @return size of the pool mapping, including the rounding to pages
+     */
+    [[nodiscard]]
+    auto pool_bytes () const noexcept -> std::size_t {
+        return _pool_bytes;
+    }
+    
+    [[nodiscard]]
+    virtual auto block_size () const noexcept -> std::size_t final {
+        return _block_size;
+    }
+    
+    /**
+     * @return 0 if the storage is not valid
+     */
+    [[nodiscard]]
+    virtual auto blocks_count () const noexcept -> std::size_t final {
+        return _blocks_count;
+    }
+    
+    [[nodiscard]]
+    virtual auto allocate_block () noexcept -> T* final {
+        if (!valid()) {
+            return nullptr;
+        }
+        auto i = _implementation::bitmap_take(
+            _free_bits, _free_words, _blocks_count
+        ); ///< O(1)
+        if (i == _blocks_count) {
+            return nullptr;
+        }
+        return _pool_of_T + i * _block_size;
+    }
+    
+    virtual auto deallocate_block (T* p) noexcept -> void final {
+        auto i = _index_of(p); ///< O(1)
+        if (i == _blocks_count) {
+            return;
+        }
+        _implementation::bitmap_give(_free_bits, _free_words, i); ///< O(1)
+    }
+    
+    [[nodiscard]]
+    virtual auto allocate_blocks (T** out, std::size_t count) noexcept
+    -> std::size_t final {
+        if (!valid()) {
+            return 0u;
+        }
+        auto n = std::size_t(0u);
+        return _implementation::bitmap_take_n(
+            _free_bits, _free_words, _blocks_count, count,
+            [this, out, &n](std::size_t i) {
+                out[n++] = _pool_of_T + i * _block_size;
+            }
+        ); ///< O(count / 64)
+    }
+    
+    virtual auto deallocate_blocks (T* const* ps, std::size_t count) noexcept
+    -> void final {
+        for (auto i : range::range(count)) {
+            mapped_storage::deallocate_block(ps[i]);
+        }
+    }
+    
+    [[nodiscard]]
+    virtual auto owns (const T* p) const noexcept -> bool final {
+        return _index_of(p) != _blocks_count;
+    }
+    
+    [[nodiscard]]
+    virtual auto is_allocated (const T* p) const noexcept -> bool final {
+        auto i = _index_of(p); ///< O(1)
+        return (i != _blocks_count) &&
+               !_implementation::bitmap_test(_free_bits, i);
+    }
+    
+    [[nodiscard]]
+    virtual auto block_of (const T* p) noexcept -> T* final {
+        if (!valid()) {
+            return nullptr;
+        }
+        return _implementation::pool_block(
+            _pool_of_T, _block_size, _blocks_count, p
+        );
+    }
+    
+    /**
+     * @return nullptr if the storage is not valid
+     */
+    [[nodiscard]]
+    virtual auto pool_begin () const noexcept -> const T* final {
+        return _pool_of_T;
+    }
+    
+    [[nodiscard]]
+    virtual auto pool_end () const noexcept -> const T* final {
+        return _pool_of_T + _block_size * _blocks_count;
+    }
+
+private:
+    auto _map_pool (std::size_t bytes) noexcept -> void {
+#ifdef MAP_HUGETLB
+        if (_pages == beefy::pages::huge) {
+            _pool_bytes = _implementation::round_up(
+                bytes, _implementation::huge_page_size
+            );
+            _pool_of_T = static_cast<T*>(
+                _implementation::map_anonymous(_pool_bytes, MAP_HUGETLB)
+            );
+            if (_pool_of_T != nullptr) {
+                return;
+            }
+            _pages = beefy::pages::transparent;
+        }
+#else
+        if (_pages == beefy::pages::huge) {
+            _pages = beefy::pages::transparent;
+        }
+#endif
+#ifdef MADV_HUGEPAGE
+        if (_pages == beefy::pages::transparent) {
+            _pool_bytes = _implementation::round_up(
+                bytes, _implementation::huge_page_size
+            );
+            _pool_of_T = static_cast<T*>(_implementation::map_aligned(
+                _pool_bytes, _implementation::huge_page_size
+            ));
+            if (_pool_of_T == nullptr) {
+                return;
+            }
+            if (::madvise(_pool_of_T, _pool_bytes, MADV_HUGEPAGE) != 0) {
+                _pages = beefy::pages::normal; ///< THP are off
+            }
+            return;
+        }
+#else
+        _pages = beefy::pages::normal;
+#endif
+        _pool_bytes = bytes;
+        _pool_of_T = static_cast<T*>(
+            _implementation::map_anonymous(_pool_bytes)
+        );
+    }
+    
+    auto _map_control () noexcept -> void {
+        auto words = _implementation::bitmap_words_count(_blocks_count);
+        auto summary = _implementation::bitmap_summary_count(_blocks_count);
+        _control_bytes = (words + summary) * sizeof(word_t);
+        /// mapped memory is zeroed, as the bitmaps need
+        _free_bits = static_cast<word_t*>(
+            _implementation::map_anonymous(_control_bytes)
+        );
+        if (_free_bits == nullptr) {
+            return;
+        }
+        _free_words = _free_bits + words;
+        _implementation::bitmap_fill(_free_bits, _free_words, _blocks_count);
+    }
+    
+    auto _unmap () noexcept -> void {
+        if (_pool_of_T != nullptr) {
+            ::munmap(_pool_of_T, _pool_bytes);
+            _pool_of_T = nullptr;
+        }
+        if (_free_bits != nullptr) {
+            ::munmap(_free_bits, _control_bytes);
+            _free_bits = nullptr;
+            _free_words = nullptr;
+        }
+    }
+    
+    [[nodiscard]]
+    auto _index_of (const T* p) const noexcept -> std::size_t {
+        if (!valid()) {
+            return _blocks_count;
+        }
+        return _implementation::pool_index(
+            _pool_of_T, _block_size, _blocks_count, p
+        );
+    }
+};
+
+}
+
+}
+
+}
+
+#endif /// __has_include(<sys/mman.h>)
+
+#endif /// KCPPT_ALLOCATORS_BEEFY_MAPPED_STORAGE_HPP
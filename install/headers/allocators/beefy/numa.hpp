@@ -0,0 +1,466 @@
+/** @file numa.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  NUMA-aware front-end for the beefy storages: a set of pools per
+ *         node, requests go to the node of the calling thread.
+ *
+ * @details
+ *
+ *        Every node gets its own 'mapped_storage' per size class. The pools
+ *        are bound to their node (mbind) before their pages are touched, and
+ *        optionally prefaulted, so the memory really is local to the node.
+ *
+ *        Allocation takes a block from the pool of the calling thread's node,
+ *        if it is exhausted the other nodes are tried in order. Deallocation
+ *        gives the block back to whichever node owns it, O(nodes).
+ *
+ *        The node layout comes from a topology:
+ *        - system_topology -- the nodes of the machine (sysfs), the node of
+ *          the calling thread (getcpu), binding with mbind
+ *        - simulated_topology -- any number of nodes on any machine, the
+ *          node of a thread is set by the thread itself, nothing is bound.
+ *          Lets the routing be exercised on a single-node box.
+ *        Any class with nodes_count(), current_node() and bind(p, bytes,
+ *        node) can be used.
+ *
+ *        Every pool has its own lock. Per-node stats (local allocations,
+ *        allocations served by a remote node, failures) are atomic counters.
+ *
+ *        Only available on Linux.
+ *
+ * Usage example:
+ *
+ * static auto heap = numa::allocator<char, 2>({{{64, 100000}, {4096, 1000}}});
+ *
+ * auto p = heap.allocate(100); ///< from the node of this thread
+ * heap.deallocate(p, 100);
+ * auto remote = heap.stats(0).remote;
+ */
+
+#ifndef KCPPT_ALLOCATORS_BEEFY_NUMA_HPP
+#define KCPPT_ALLOCATORS_BEEFY_NUMA_HPP
+
+#include "mapped_storage.hpp"
+
+#if __has_include(<sys/mman.h>) && __has_include(<sys/syscall.h>) && \
+    __has_include(<unistd.h>)
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace beefy {
+
+namespace numa {
+
+namespace _implementation {
+
+/**
+ * @brief MPOL_BIND of <numaif.h>, which is not always installed
+ */
+constexpr static auto mpol_bind = 2;
+
+}
+
+class system_topology {
+private:
+    std::size_t _nodes_count;
+
+public:
+    /**
+     * @brief Nodes are read from sysfs, 1 if it is not available
+     */
+    system_topology () noexcept :
+        _nodes_count(_read_nodes_count())
+    {}
+
+public:
+    [[nodiscard]]
+    auto nodes_count () const noexcept -> std::size_t {
+        return _nodes_count;
+    }
+    
+    /**
+     * @return node of the CPU the calling thread runs on, 0 if unknown
+     */
+    [[nodiscard]]
+    auto current_node () const noexcept -> std::size_t {
+#ifdef SYS_getcpu
+        unsigned cpu = 0u;
+        unsigned node = 0u;
+        if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+            return node;
+        }
+#endif
+        return 0u;
+    }
+    
+    /**
+     * @brief Bind the (untouched) pages to the node
+     * @return false if the memory policy could not be set
+     */
+    auto bind (void* p, std::size_t bytes, std::size_t node) const noexcept
+    -> bool {
+#ifdef SYS_mbind
+        constexpr auto mask_width = sizeof(unsigned long) * CHAR_BIT;
+        if (node >= mask_width) {
+            return false;
+        }
+        auto mask = 1ul << node;
+        return ::syscall(
+            SYS_mbind, p, bytes, _implementation::mpol_bind,
+            &mask, mask_width, 0u
+        ) == 0;
+#else
+        return false;
+#endif
+    }
+
+private:
+    /**
+     * @brief "/sys/devices/system/node/possible" is like "0" or "0-3"
+     */
+    [[nodiscard]]
+    static auto _read_nodes_count () noexcept -> std::size_t {
+        auto f = std::fopen("/sys/devices/system/node/possible", "r");
+        if (f == nullptr) {
+            return 1u;
+        }
+        auto first = 0u;
+        auto last = 0u;
+        auto n = std::fscanf(f, "%u-%u", &first, &last);
+        std::fclose(f);
+        if (n == 2) {
+            return last + 1u;
+        }
+        return (n == 1) ? first + 1u : 1u;
+    }
+};
+
+class simulated_topology {
+private:
+    std::size_t _nodes_count;
+
+public:
+    explicit simulated_topology (std::size_t nodes_count) noexcept :
+        _nodes_count((nodes_count != 0u) ? nodes_count : 1u)
+    {}
+
+public:
+    [[nodiscard]]
+    auto nodes_count () const noexcept -> std::size_t {
+        return _nodes_count;
+    }
+    
+    [[nodiscard]]
+    auto current_node () const noexcept -> std::size_t {
+        return _thread_node();
+    }
+    
+    /**
+     * @brief Nothing is bound, all the nodes share the real one
+     */
+    auto bind (void*, std::size_t, std::size_t) const noexcept -> bool {
+        return true;
+    }
+    
+    /**
+     * @brief Pretend that the calling thread runs on 'node'
+     */
+    static auto set_current_node (std::size_t node) noexcept -> void {
+        _thread_node() = node;
+    }
+
+private:
+    [[nodiscard]]
+    static auto _thread_node () noexcept -> std::size_t& {
+        thread_local std::size_t node = 0u;
+        return node;
+    }
+};
+
+/**
+ * @brief Pool parameters of a size class, the same on every node
+ */
+struct size_class {
+    std::size_t block_size;
+    std::size_t blocks_count;
+};
+
+/**
+ * @tparam T
+ * @tparam ClassesCount -- number of size classes per node
+ * @tparam MaxNodes -- upper bound of the nodes, the rest are not used
+ * @tparam Topology -- system_topology, simulated_topology or alike
+ */
+template <
+    typename T,
+    std::size_t ClassesCount,
+    std::size_t MaxNodes = 8u,
+    typename Topology = system_topology
+>
+class allocator {
+    static_assert(!std::is_void_v<T>);
+    static_assert(ClassesCount != 0u);
+    static_assert(MaxNodes != 0u);
+
+public:
+    using classes_t = std::array<size_class, ClassesCount>;
+    
+    struct node_stats {
+        /**
+         * @brief allocations served by the node of the calling thread
+         */
+        std::size_t local;
+        /**
+         * @brief allocations of the threads of this node served by
+         *        another node
+         */
+        std::size_t remote;
+        /**
+         * @brief allocations of the threads of this node that failed
+         */
+        std::size_t failures;
+        /**
+         * @brief pools that could not be bound to this node
+         */
+        std::size_t unbound_pools;
+    };
+
+private:
+    struct node {
+        std::array<std::optional<mapped_storage<T>>, ClassesCount> storages;
+        std::array<std::mutex, ClassesCount> locks;
+        std::atomic<std::size_t> local;
+        std::atomic<std::size_t> remote;
+        std::atomic<std::size_t> failures;
+        std::size_t unbound_pools;
+    };
+
+private:
+    Topology _topology;
+    classes_t _classes;
+    std::size_t _nodes_count;
+    std::array<node, MaxNodes> _nodes;
+
+public:
+    /**
+     * @param classes -- ascending-sorted by unique block sizes
+     * @param topology
+     * @param prefault -- touch every page right away, so the memory is
+     *        committed on its node now rather than on the first use
+     */
+    explicit allocator (
+        const classes_t& classes,
+        Topology topology = Topology(),
+        bool prefault = false
+    ) noexcept :
+        _topology(std::move(topology)),
+        _classes(classes),
+        _nodes_count(
+            (_topology.nodes_count() < MaxNodes) ?
+            _topology.nodes_count() : MaxNodes
+        ),
+        _nodes()
+    {
+        for (auto n : range::range(_nodes_count)) {
+            for (auto i : range::range(ClassesCount)) {
+                _make_pool(n, i, prefault);
+            }
+        }
+    }
+    
+    allocator (const allocator&) = delete;
+    auto operator= (const allocator&) -> allocator& = delete;
+
+public:
+    [[nodiscard]]
+    auto allocate (std::size_t nT) noexcept -> T* {
+        auto i = _class_of(nT); ///< O(log classes)
+        if (i == ClassesCount) {
+            return nullptr;
+        }
+        auto local = _topology.current_node() % _nodes_count;
+        for (auto k : range::range(_nodes_count)) { ///< local node first
+            auto n = (local + k) % _nodes_count;
+            auto p = _allocate_from(n, i);
+            if (p == nullptr) {
+                continue;
+            }
+            if (k == 0u) {
+                _nodes[local].local.fetch_add(1u, std::memory_order_relaxed);
+            } else {
+                _nodes[local].remote.fetch_add(1u, std::memory_order_relaxed);
+            }
+            return p;
+        }
+        _nodes[local].failures.fetch_add(1u, std::memory_order_relaxed);
+        return nullptr;
+    }
+    
+    auto deallocate (T* p, std::size_t nT) noexcept -> void {
+        auto i = _class_of(nT);
+        if (i != ClassesCount) {
+            for (auto n : range::range(_nodes_count)) { ///< O(nodes)
+                if (_deallocate_to(n, i, p)) {
+                    return;
+                }
+            }
+        }
+        deallocate(p); ///< a wrong size must not leak the block
+    }
+    
+    /**
+     * @brief Same as above, but every class of every node is looked at,
+     *        O(nodes * classes)
+     */
+    auto deallocate (T* p) noexcept -> void {
+        for (auto n : range::range(_nodes_count)) {
+            for (auto i : range::range(ClassesCount)) {
+                if (_deallocate_to(n, i, p)) {
+                    return;
+                }
+            }
+        }
+    }
+    
+    [[nodiscard]]
+    auto nodes_count () const noexcept -> std::size_t {
+        return _nodes_count;
+    }
+    
+    /**
+     * @return node the block belongs to, nodes_count() if none
+     */
+    [[nodiscard]]
+    auto node_of (const T* p) const noexcept -> std::size_t {
+        for (auto n : range::range(_nodes_count)) {
+            for (auto& s : _nodes[n].storages) {
+                if (s && s->owns(p)) {
+                    return n;
+                }
+            }
+        }
+        return _nodes_count;
+    }
+    
+    [[nodiscard]]
+    auto stats (std::size_t n) const noexcept -> node_stats {
+        if (n >= _nodes_count) {
+            return {};
+        }
+        auto& nd = _nodes[n];
+        return {
+            nd.local.load(std::memory_order_relaxed),
+            nd.remote.load(std::memory_order_relaxed),
+            nd.failures.load(std::memory_order_relaxed),
+            nd.unbound_pools
+        };
+    }
+
+private:
+    auto _make_pool (std::size_t n, std::size_t i, bool prefault) noexcept
+    -> void {
+        auto& s = _nodes[n].storages[i].emplace(
+            _classes[i].block_size, _classes[i].blocks_count
+        );
+        if (!s.valid()) {
+            return;
+        }
+        /// the policy must be set before the first touch
+        if (!_topology.bind(s.pool(), s.pool_bytes(), n)) {
+            ++_nodes[n].unbound_pools;
+        }
+        if (prefault) {
+            auto bytes = reinterpret_cast<volatile unsigned char*>(s.pool());
+            auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            for (auto b : range::range(std::size_t(0u), s.pool_bytes(), page)) {
+                bytes[b] = 0u;
+            }
+        }
+    }
+    
+    [[nodiscard]]
+    auto _allocate_from (std::size_t n, std::size_t i) noexcept -> T* {
+        std::lock_guard<std::mutex> guard(_nodes[n].locks[i]);
+        return _nodes[n].storages[i]->allocate_block();
+    }
+    
+    [[nodiscard]]
+    auto _deallocate_to (std::size_t n, std::size_t i, T* p) noexcept
+    -> bool {
+        auto& s = *_nodes[n].storages[i];
+        if (!s.owns(p)) { ///< the pool range never changes, no lock needed
+            return false;
+        }
+        std::lock_guard<std::mutex> guard(_nodes[n].locks[i]);
+        s.deallocate_block(p);
+        return true;
+    }
+    
+    /**
+     * @return the first class with block_size >= nT, ClassesCount if none
+     */
+    [[nodiscard]]
+    auto _class_of (std::size_t nT) const noexcept -> std::size_t {
+        if (nT == 0u) {
+            return ClassesCount;
+        }
+        auto lo = std::size_t(0u);
+        auto hi = ClassesCount;
+        while (lo != hi) {
+            auto mid = lo + (hi - lo) / 2u;
+            if (_classes[mid].block_size < nT) {
+                lo = mid + 1u;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+};
+
+}
+
+}
+
+}
+
+}
+
+#endif /// sys/mman.h, sys/syscall.h, unistd.h
+
+#endif /// KCPPT_ALLOCATORS_BEEFY_NUMA_HPP
@@ -0,0 +1,227 @@
+/** @file pmr.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  std::pmr::memory_resource backed by a set of beefy storages, so that
+ *         std::pmr containers can take their memory from the static pools.
+ *
+ * @details
+ *
+ *        Requests are served by the smallest storage that fits the requested
+ *        number of bytes. If it has no free blocks, the larger storages are
+ *        tried in turn, and only then the upstream resource (the default
+ *        resource unless specified otherwise).
+ *
+ *        The pools are cache line aligned, so blocks of power of 2 sizes are
+ *        aligned up to that. For over-aligned requests a storage whose block
+ *        stride never lands on 'alignment' is skipped. In the others the
+ *        misaligned blocks are held (up to 64 of them) until an aligned block
+ *        turns up and are given back afterwards, otherwise the same
+ *        misaligned block would come back on every try.
+ *        Deallocation gives the memory back to whoever owns it.
+ *
+ *        The storages should hold some byte type (char, unsigned char,
+ *        std::byte), for any other T the requested bytes are rounded up to
+ *        the whole number of Ts.
+ *
+ * Usage example:
+ *
+ * static auto s0 = bitmap_storage<std::byte,  32, 4096>();
+ * static auto s1 = bitmap_storage<std::byte, 256, 1024>();
+ * static auto storage = make_ptrs_to_storages_array<std::byte>(s0, s1);
+ *
+ * static auto resource = memory_resource<std::byte, decltype(storage), storage>();
+ * std::pmr::vector<int> v(&resource);
+ */
+
+#ifndef KCPPT_ALLOCATORS_BEEFY_PMR_HPP
+#define KCPPT_ALLOCATORS_BEEFY_PMR_HPP
+
+#include "../beefy.hpp"
+
+#include <memory_resource>
+#include <numeric>
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace beefy {
+
+/**
+ * @tparam T
+ * @tparam SequenceContainer
+ * @tparam Container -- same requirements as for 'allocator'
+ */
+template <
+    typename T,
+    typename SequenceContainer,
+    SequenceContainer& Container
+>
+class memory_resource final : public std::pmr::memory_resource {
+    static_assert(!std::is_void_v<T>);
+    static_assert(
+        std::is_same_v<
+            typename SequenceContainer::value_type,
+            storage_base<T>*
+        >
+    );
+
+private:
+    std::pmr::memory_resource* _upstream;
+
+public:
+    explicit memory_resource (
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource()
+    ) noexcept :
+        _upstream(upstream)
+    {}
+
+public:
+    [[nodiscard]]
+    auto upstream_resource () const noexcept -> std::pmr::memory_resource* {
+        return _upstream;
+    }
+
+private:
+    auto do_allocate (std::size_t bytes, std::size_t alignment)
+    -> void* final {
+        auto i = _implementation::search_fitting_container(
+            Container, _count_of_T(bytes)
+        );
+        for (; i < Container.size(); ++i) {
+            if (!_may_be_aligned(*Container[i], alignment)) {
+                continue;
+            }
+            auto p = _allocate_aligned(*Container[i], alignment);
+            if (p != nullptr) {
+                return p;
+            }
+        }
+        return _upstream->allocate(bytes, alignment);
+    }
+    
+    auto do_deallocate (void* p, std::size_t bytes, std::size_t alignment)
+    -> void final {
+        auto pT = static_cast<T*>(p);
+        auto i = _implementation::search_fitting_container(
+            Container, _count_of_T(bytes)
+        );
+        /// the block may come from a larger storage
+        if ((i >= Container.size()) || !Container[i]->owns(pT)) {
+            i = _implementation::search_owning_container<
+                T, SequenceContainer, Container
+            >(pT); ///< O(logn)
+        }
+        if ((i < Container.size()) && Container[i]->owns(pT)) {
+            Container[i]->deallocate_block(pT);
+            return;
+        }
+        _upstream->deallocate(p, bytes, alignment);
+    }
+    
+    [[nodiscard]]
+    auto do_is_equal (const std::pmr::memory_resource& other) const noexcept
+    -> bool final {
+        return this == &other;
+    }
+
+private:
+    /**
+     * @brief Misaligned blocks held by '_allocate_aligned' at most
+     */
+    constexpr static auto _held_blocks_count = std::size_t(64u);
+
+private:
+    /**
+     * @brief Zero bytes still take a block, the pointer must be unique
+     */
+    [[nodiscard]]
+    constexpr static auto _count_of_T (std::size_t bytes) noexcept
+    -> std::size_t {
+        return (bytes == 0u) ? 1u : (bytes + sizeof(T) - 1u) / sizeof(T);
+    }
+    
+    [[nodiscard]]
+    static auto _is_aligned (const T* p, std::size_t alignment) noexcept
+    -> bool {
+        return reinterpret_cast<std::uintptr_t>(p) % alignment == 0u;
+    }
+    
+    /**
+     * @return false if no block of 's' is aligned to 'alignment', the blocks
+     *         are at 'begin + k * stride' and some k gives an aligned address
+     *         only if gcd(stride, alignment) divides 'begin'
+     */
+    [[nodiscard]]
+    static auto _may_be_aligned (
+        const storage_base<T>& s, std::size_t alignment
+    ) noexcept -> bool {
+        if (alignment <= alignof(T)) {
+            return true;
+        }
+        if (s.blocks_count() == 0u) {
+            return false;
+        }
+        auto b = reinterpret_cast<std::uintptr_t>(s.pool_begin());
+        auto e = reinterpret_cast<std::uintptr_t>(s.pool_end());
+        auto stride = (e - b) / s.blocks_count(); ///< guards included
+        return b % std::gcd(stride, alignment) == 0u;
+    }
+    
+    /**
+     * @return block of 's' aligned to 'alignment', nullptr if none turned up
+     *         before the storage or the held blocks ran out
+     */
+    [[nodiscard]]
+    static auto _allocate_aligned (storage_base<T>& s, std::size_t alignment)
+    noexcept -> T* {
+        std::array<T*, _held_blocks_count> held;
+        auto n = std::size_t(0u);
+        auto p = static_cast<T*>(nullptr);
+        while (n != held.size()) {
+            auto q = s.allocate_block();
+            if ((q == nullptr) || _is_aligned(q, alignment)) {
+                p = q;
+                break;
+            }
+            held[n++] = q;
+        }
+        if (n != 0u) {
+            s.deallocate_blocks(held.data(), n);
+        }
+        return p;
+    }
+};
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_ALLOCATORS_BEEFY_PMR_HPP
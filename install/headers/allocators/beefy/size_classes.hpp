@@ -0,0 +1,488 @@
+/** @file size_classes.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Compile-time generation of beefy storage sets from a memory budget.
+ *
+ * @details
+ *
+ *        Instead of listing the storages by hand (and keeping them sorted
+ *        and unique) a policy picks the block sizes and 'storage_set'
+ *        splits the budget between them:
+ *        - pow2<Min, Max> -- powers of two from Min to Max (both rounded up)
+ *        - geometric<Min, Max, Num, Den> -- every block size is Num / Den of
+ *          the previous one (5 / 4 by default), rounded up, up to Max
+ *        - histogram<Sizes, Frequencies, MaxClasses> -- expected request
+ *          sizes with their relative frequencies. If there are more unique
+ *          sizes than MaxClasses, the sizes are grouped so that the expected
+ *          internal fragmentation (unused Ts of the blocks) is minimal.
+ *
+ *        All sizes are in Ts, the budget is in bytes.
+ *        pow2 and geometric give every class the same share of the budget,
+ *        histogram gives every class the share of the expected usage.
+ *        Every class gets at least one block.
+ *
+ * Usage example:
+ *
+ * using set = storage_set<char, 1u << 20u, size_classes::geometric<8, 4096>>;
+ *
+ * static auto storages = set::storages_t();
+ * static auto ptrs = set::make_ptrs(storages);
+ *
+ * using alloc = allocator<char, decltype(ptrs), ptrs>;
+ *
+ * /// or, with measured request sizes
+ * constexpr static std::array<std::size_t, 4> sizes {24, 40, 48, 200};
+ * constexpr static std::array<std::size_t, 4> freqs {90, 5, 40, 1};
+ * using measured = storage_set<
+ *     char, 1u << 16u, size_classes::histogram<sizes, freqs, 3>, bitmap_storage
+ * >;
+ */
+
+#ifndef KCPPT_ALLOCATORS_BEEFY_SIZE_CLASSES_HPP
+#define KCPPT_ALLOCATORS_BEEFY_SIZE_CLASSES_HPP
+
+#include "../beefy.hpp"
+#include "../../pow2.hpp"
+
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace beefy {
+
+namespace size_classes {
+
+struct size_class {
+    std::size_t block_size;
+    std::size_t blocks_count;
+};
+
+template <std::size_t MinBlockSize, std::size_t MaxBlockSize>
+struct pow2 {
+    static_assert(MinBlockSize != 0u);
+    static_assert(MinBlockSize <= MaxBlockSize);
+
+private:
+    constexpr static auto _min = kcppt::pow2::greater_equal(
+        std::size_t(MinBlockSize)
+    );
+    constexpr static auto _max = kcppt::pow2::greater_equal(
+        std::size_t(MaxBlockSize)
+    );
+
+public:
+    constexpr static auto count = static_cast<std::size_t>(
+        bitwise::rshift_count<std::size_t, 1, 1>(_max / _min)
+    );
+    
+    [[nodiscard]]
+    constexpr static auto block_sizes () noexcept
+    -> std::array<std::size_t, count> {
+        std::array<std::size_t, count> ret {};
+        auto bs = _min;
+        for (auto i : range::range(count)) {
+            ret[i] = bs;
+            bs *= 2u;
+        }
+        return ret;
+    }
+    
+    /**
+     * @return shares of the budget
+     */
+    [[nodiscard]]
+    constexpr static auto weights () noexcept
+    -> std::array<std::size_t, count> {
+        std::array<std::size_t, count> ret {};
+        for (auto i : range::range(count)) {
+            ret[i] = 1u;
+        }
+        return ret;
+    }
+};
+
+template <
+    std::size_t MinBlockSize,
+    std::size_t MaxBlockSize,
+    std::size_t Num = 5u,
+    std::size_t Den = 4u
+>
+struct geometric {
+    static_assert(MinBlockSize != 0u);
+    static_assert(MinBlockSize <= MaxBlockSize);
+    static_assert(Den != 0u && Num > Den, "the step must be greater than 1");
+
+private:
+    /**
+     * @brief At least one T bigger, small sizes would repeat otherwise
+     */
+    [[nodiscard]]
+    constexpr static auto _next (std::size_t bs) noexcept -> std::size_t {
+        auto n = (bs * Num + Den - 1u) / Den;
+        return (n > bs) ? n : bs + 1u;
+    }
+    
+    [[nodiscard]]
+    constexpr static auto _count () noexcept -> std::size_t {
+        auto n = std::size_t(1u);
+        for (auto bs = MinBlockSize; bs < MaxBlockSize; bs = _next(bs)) {
+            ++n;
+        }
+        return n;
+    }
+
+public:
+    constexpr static auto count = _count();
+    
+    /**
+     * @brief The last block size is MaxBlockSize exactly
+     */
+    [[nodiscard]]
+    constexpr static auto block_sizes () noexcept
+    -> std::array<std::size_t, count> {
+        std::array<std::size_t, count> ret {};
+        auto bs = MinBlockSize;
+        for (auto i : range::range(count - 1u)) {
+            ret[i] = bs;
+            bs = _next(bs);
+        }
+        ret[count - 1u] = MaxBlockSize;
+        return ret;
+    }
+    
+    [[nodiscard]]
+    constexpr static auto weights () noexcept
+    -> std::array<std::size_t, count> {
+        std::array<std::size_t, count> ret {};
+        for (auto i : range::range(count)) {
+            ret[i] = 1u;
+        }
+        return ret;
+    }
+};
+
+namespace _implementation {
+
+template <std::size_t N>
+struct histogram_data {
+    std::size_t count;
+    std::array<std::size_t, N> sizes;
+    std::array<std::size_t, N> frequencies;
+};
+
+/**
+ * @brief Sorts the sizes, merges the equal ones and drops the zero ones
+ */
+template <std::size_t N>
+[[nodiscard]]
+constexpr auto make_histogram_data (
+    const std::array<std::size_t, N>& sizes,
+    const std::array<std::size_t, N>& frequencies
+) noexcept -> histogram_data<N> {
+    histogram_data<N> ret {0u, sizes, frequencies};
+    for (auto i : range::range(std::size_t(1u), N)) {
+        for (auto j = i; (j != 0u) && (ret.sizes[j - 1u] > ret.sizes[j]); --j) {
+            auto s = ret.sizes[j];
+            ret.sizes[j] = ret.sizes[j - 1u];
+            ret.sizes[j - 1u] = s;
+            auto f = ret.frequencies[j];
+            ret.frequencies[j] = ret.frequencies[j - 1u];
+            ret.frequencies[j - 1u] = f;
+        }
+    }
+    for (auto i : range::range(N)) {
+        if (ret.sizes[i] == 0u) {
+            continue;
+        }
+        if ((ret.count != 0u) && (ret.sizes[ret.count - 1u] == ret.sizes[i])) {
+            ret.frequencies[ret.count - 1u] += ret.frequencies[i];
+            continue;
+        }
+        ret.sizes[ret.count] = ret.sizes[i];
+        ret.frequencies[ret.count] = ret.frequencies[i];
+        ++ret.count;
+    }
+    return ret;
+}
+
+/**
+ * @brief Optimal split of the sorted sizes into K contiguous groups, each
+ *        group is served by the block of its largest size.
+ *        dp[k][j] -- the least waste of the first j sizes in k groups,
+ *        O(K * n^2).
+ * @return index of the first size of every group, plus n at [K]
+ */
+template <std::size_t N, std::size_t K>
+[[nodiscard]]
+constexpr auto split_histogram (const histogram_data<N>& h) noexcept
+-> std::array<std::size_t, K + 1u> {
+    constexpr auto inf = std::numeric_limits<std::size_t>::max();
+    const auto n = h.count;
+    /// prefix sums of the frequencies and of the requested Ts
+    std::size_t fs[N + 1u] {};
+    std::size_t ts[N + 1u] {};
+    for (auto i : range::range(n)) {
+        fs[i + 1u] = fs[i] + h.frequencies[i];
+        ts[i + 1u] = ts[i] + h.frequencies[i] * h.sizes[i];
+    }
+    std::size_t dp[K + 1u][N + 1u] {};
+    std::size_t cut[K + 1u][N + 1u] {};
+    for (auto k : range::range(K + 1u)) {
+        for (auto j : range::range(n + 1u)) {
+            dp[k][j] = inf;
+        }
+    }
+    dp[0][0] = 0u;
+    for (auto k : range::range(std::size_t(1u), K + 1u)) {
+        for (auto j : range::range(k, n + 1u)) {
+            for (auto a : range::range(k - 1u, j)) {
+                if (dp[k - 1u][a] == inf) {
+                    continue;
+                }
+                /// sizes [a, j) in the block of size sizes[j - 1]
+                auto waste = h.sizes[j - 1u] * (fs[j] - fs[a]) -
+                             (ts[j] - ts[a]);
+                if (dp[k - 1u][a] + waste < dp[k][j]) {
+                    dp[k][j] = dp[k - 1u][a] + waste;
+                    cut[k][j] = a;
+                }
+            }
+        }
+    }
+    std::array<std::size_t, K + 1u> ret {};
+    ret[K] = n;
+    for (auto k = K; k != 0u; --k) {
+        ret[k - 1u] = cut[k][ret[k]];
+    }
+    return ret;
+}
+
+}
+
+/**
+ * @tparam Sizes -- std::array<std::size_t, N> of expected request sizes,
+ *         in any order, may repeat
+ * @tparam Frequencies -- std::array<std::size_t, N> of their relative
+ *         frequencies
+ * @tparam MaxClasses -- upper bound of the storages count
+ */
+template <
+    const auto& Sizes,
+    const auto& Frequencies,
+    std::size_t MaxClasses = std::tuple_size_v<
+        std::remove_cv_t<std::remove_reference_t<decltype(Sizes)>>
+    >
+>
+struct histogram {
+    static_assert(
+        std::is_same_v<decltype(Sizes), decltype(Frequencies)>,
+        "sizes and frequencies must be of the same array type"
+    );
+    static_assert(MaxClasses != 0u);
+
+private:
+    constexpr static auto _n = std::tuple_size_v<
+        std::remove_cv_t<std::remove_reference_t<decltype(Sizes)>>
+    >;
+    
+    constexpr static auto _data = _implementation::make_histogram_data(
+        Sizes, Frequencies
+    );
+    
+    static_assert(_data.count != 0u, "no non-zero sizes");
+
+public:
+    constexpr static auto count =
+        (_data.count < MaxClasses) ? _data.count : MaxClasses;
+
+private:
+    constexpr static auto _groups =
+        _implementation::split_histogram<_n, count>(_data);
+
+public:
+    [[nodiscard]]
+    constexpr static auto block_sizes () noexcept
+    -> std::array<std::size_t, count> {
+        std::array<std::size_t, count> ret {};
+        for (auto k : range::range(count)) {
+            ret[k] = _data.sizes[_groups[k + 1u] - 1u];
+        }
+        return ret;
+    }
+    
+    /**
+     * @return expected Ts taken by the blocks of every class
+     */
+    [[nodiscard]]
+    constexpr static auto weights () noexcept
+    -> std::array<std::size_t, count> {
+        std::array<std::size_t, count> ret {};
+        for (auto k : range::range(count)) {
+            for (auto i : range::range(_groups[k], _groups[k + 1u])) {
+                ret[k] += _data.frequencies[i];
+            }
+            ret[k] *= _data.sizes[_groups[k + 1u] - 1u];
+        }
+        return ret;
+    }
+    
+    /**
+     * @return expected unused Ts per request, 0 if every size has a class
+     */
+    [[nodiscard]]
+    constexpr static auto expected_waste () noexcept -> double {
+        auto waste = std::size_t(0u);
+        auto total = std::size_t(0u);
+        for (auto k : range::range(count)) {
+            auto bs = _data.sizes[_groups[k + 1u] - 1u];
+            for (auto i : range::range(_groups[k], _groups[k + 1u])) {
+                waste += (bs - _data.sizes[i]) * _data.frequencies[i];
+                total += _data.frequencies[i];
+            }
+        }
+        return (total == 0u) ? 0.0 : double(waste) / double(total);
+    }
+};
+
+}
+
+namespace _implementation {
+
+/**
+ * @brief blocks_count = budget * weight / sum of weights / block_size
+ */
+template <typename Policy>
+[[nodiscard]]
+constexpr auto distribute_budget (std::size_t budget_of_T) noexcept
+-> std::array<size_classes::size_class, Policy::count> {
+    constexpr auto block_sizes = Policy::block_sizes();
+    constexpr auto weights = Policy::weights();
+    
+    auto total = 0.0;
+    for (auto w : weights) {
+        total += double(w);
+    }
+    std::array<size_classes::size_class, Policy::count> ret {};
+    for (auto i : range::range(Policy::count)) {
+        auto share = (total == 0.0) ?
+            double(budget_of_T) / double(Policy::count) :
+            double(budget_of_T) * double(weights[i]) / total;
+        auto n = static_cast<std::size_t>(share / double(block_sizes[i]));
+        ret[i] = {block_sizes[i], (n != 0u) ? n : 1u};
+    }
+    return ret;
+}
+
+}
+
+/**
+ * @tparam T
+ * @tparam BudgetBytes -- total size of the pools
+ * @tparam Policy -- one of size_classes::pow2, geometric, histogram
+ * @tparam Storage -- storage template (storage, bitmap_storage,
+ *         lockfree_storage...)
+ */
+template <
+    typename T,
+    std::size_t BudgetBytes,
+    typename Policy,
+    template <typename, std::size_t, std::size_t> class Storage = storage
+>
+class storage_set {
+    static_assert(!std::is_void_v<T>);
+    static_assert(Policy::count != 0u);
+
+public:
+    constexpr static auto classes =
+        _implementation::distribute_budget<Policy>(BudgetBytes / sizeof(T));
+
+private:
+    template <std::size_t...Is>
+    static auto _storages (std::index_sequence<Is...>) noexcept -> std::tuple<
+        Storage<T, classes[Is].block_size, classes[Is].blocks_count>...
+    >;
+    
+    template <std::size_t...Is>
+    constexpr static auto _is_sorted (std::index_sequence<Is...>) noexcept
+    -> bool {
+        return sequence::is_strictly_sorted(classes[Is].block_size...);
+    }
+    
+    static_assert(
+        _is_sorted(std::make_index_sequence<Policy::count>()),
+        "size classes must be ascending-sorted and unique"
+    );
+
+public:
+    /**
+     * @brief std::tuple of the storages, ascending-sorted by block sizes
+     */
+    using storages_t = decltype(
+        _storages(std::make_index_sequence<Policy::count>())
+    );
+    
+    using ptrs_t = ptrs_to_storages_array_t<T, Policy::count>;
+    
+    /**
+     * @return pool bytes actually taken, may exceed the budget if it is too
+     *         small to give every class a block
+     */
+    [[nodiscard]]
+    constexpr static auto pools_size () noexcept -> std::size_t {
+        auto n = std::size_t(0u);
+        for (auto c : classes) {
+            n += c.block_size * c.blocks_count * sizeof(T);
+        }
+        return n;
+    }
+    
+    /**
+     * @return pointers to the storages for 'allocator' and friends
+     */
+    [[nodiscard]]
+    static auto make_ptrs (storages_t& storages) noexcept -> ptrs_t {
+        return std::apply(
+            [](auto&...ss) {
+                return make_ptrs_to_storages_array<T>(ss...);
+            },
+            storages
+        );
+    }
+};
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_ALLOCATORS_BEEFY_SIZE_CLASSES_HPP
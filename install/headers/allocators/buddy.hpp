@@ -0,0 +1,316 @@
+/** @file buddy.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Static buddy allocator, a single pool serves requests of any size.
+ *
+ * @details
+ *
+ *        The pool of TPoolSize Ts is split into blocks of
+ *        TMinBlockSize * 2^k Ts, k is the order of the block, from 0 up to
+ *        the order of the whole pool. A request is rounded up to the
+ *        nearest power of 2 of the minimal blocks.
+ *
+ *        Every order has its own free bitmap (the two-level bitmap of the
+ *        beefy storages) and a count of free blocks:
+ *        - allocation takes a free block of the lowest order that is not
+ *          lower than requested and splits it in halves until the requested
+ *          order is reached, the second halves become free
+ *        - deallocation frees the block and merges it with its buddy (the
+ *          other half of the same parent block) while the buddy is free
+ *        Both are O(logN) in the number of orders plus the bitmap lookup.
+ *
+ *        The order of every allocated block is kept in a byte per minimal
+ *        block, so the memory can be returned without its size and the
+ *        pointers that are not allocated blocks are ignored.
+ *
+ *        Overhead is a bit per block of every order (about 2 bits per minimal
+ *        block) and a byte per minimal block.
+ *        Internal fragmentation is up to a half of the block.
+ *
+ *        The allocator is not synchronized.
+ *
+ * Usage example:
+ *
+ * static auto heap = buddy::allocator<char, 16, 1u << 20u>();
+ *
+ * auto p = heap.allocate(2222); ///< a block of 4096 chars
+ * heap.deallocate(p, 2222);
+ */
+
+#ifndef KCPPT_ALLOCATORS_BUDDY_HPP
+#define KCPPT_ALLOCATORS_BUDDY_HPP
+
+#include "beefy.hpp"
+#include "../log2.hpp"
+#include "../pow2.hpp"
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace buddy {
+
+/**
+ * @tparam T
+ * @tparam TMinBlockSize -- size of the smallest block in Ts, power of 2
+ * @tparam TPoolSize -- size of the pool in Ts, power of 2
+ */
+template <typename T, std::size_t TMinBlockSize, std::size_t TPoolSize>
+class allocator {
+    static_assert(!std::is_void_v<T>);
+    static_assert(pow2::is_pow2(std::size_t(TMinBlockSize)));
+    static_assert(pow2::is_pow2(std::size_t(TPoolSize)));
+    static_assert(TMinBlockSize != 0u);
+    static_assert(TMinBlockSize <= TPoolSize);
+
+private:
+    using word_t = beefy::_implementation::bitmap_word_t;
+    
+    /**
+     * @brief number of minimal blocks
+     */
+    constexpr static auto _units = TPoolSize / TMinBlockSize;
+
+public:
+    constexpr static auto orders_count = static_cast<std::size_t>(
+        log2::greater_equal(std::size_t(_units)) + 1
+    );
+
+private:
+    using offsets_t = std::array<std::size_t, orders_count + 1u>;
+    
+    /**
+     * @brief Bitmaps of all orders are kept one after another,
+     *        order k has _units >> k bits
+     */
+    template <typename F>
+    [[nodiscard]]
+    constexpr static auto _build_offsets (F&& words_count) noexcept
+    -> offsets_t {
+        offsets_t ret {};
+        for (auto k : range::range(orders_count)) {
+            ret[k + 1u] = ret[k] + words_count(_units >> k);
+        }
+        return ret;
+    }
+    
+    constexpr static auto _bits_offsets = _build_offsets(
+        beefy::_implementation::bitmap_words_count
+    );
+    constexpr static auto _summary_offsets = _build_offsets(
+        beefy::_implementation::bitmap_summary_count
+    );
+
+private:
+    alignas(beefy::_implementation::cache_line_size)
+    T _pool_of_T[TPoolSize];
+    /**
+     * @brief free blocks of every order, free -- 1
+     */
+    std::array<word_t, _bits_offsets[orders_count]> _free_bits;
+    std::array<word_t, _summary_offsets[orders_count]> _free_words;
+    std::array<std::size_t, orders_count> _free_count;
+    /**
+     * @brief order + 1 of the allocated block that starts at the minimal
+     *        block, 0 for the rest
+     */
+    std::array<std::uint8_t, _units> _allocated_orders;
+
+public:
+    allocator () noexcept :
+        _pool_of_T(),
+        _free_bits(),
+        _free_words(),
+        _free_count(),
+        _allocated_orders()
+    {
+        _give(orders_count - 1u, 0u); ///< the whole pool
+    }
+    
+    allocator (const allocator&) = delete;
+    auto operator= (const allocator&) -> allocator& = delete;
+
+public:
+    /**
+     * @return nullptr if nT is 0, larger than the pool or there is no free
+     *         block large enough
+     */
+    [[nodiscard]]
+    auto allocate (std::size_t nT) noexcept -> T* {
+        if ((nT == 0u) || (nT > TPoolSize)) {
+            return nullptr;
+        }
+        auto k = order_of(nT);
+        
+        auto j = k;
+        while ((j != orders_count) && (_free_count[j] == 0u)) { ///< O(logN)
+            ++j;
+        }
+        if (j == orders_count) {
+            return nullptr;
+        }
+        
+        auto i = _take(j);
+        while (j != k) { ///< O(logN) splits
+            --j;
+            i *= 2u;
+            _give(j, i + 1u);
+        }
+        
+        auto unit = i << k;
+        _allocated_orders[unit] = static_cast<std::uint8_t>(k + 1u);
+        return _pool_of_T + unit * TMinBlockSize;
+    }
+    
+    /**
+     * @brief The size is only checked against the order of the block
+     */
+    auto deallocate (T* p, std::size_t nT) noexcept -> void {
+        auto unit = _unit_of(p);
+        if ((unit == _units) || (nT == 0u) || (nT > TPoolSize) ||
+            (_allocated_orders[unit] != order_of(nT) + 1u)) {
+            return;
+        }
+        _deallocate_unit(unit);
+    }
+    
+    auto deallocate (T* p) noexcept -> void {
+        auto unit = _unit_of(p);
+        if ((unit == _units) || (_allocated_orders[unit] == 0u)) {
+            return;
+        }
+        _deallocate_unit(unit);
+    }
+    
+    [[nodiscard]]
+    auto owns (const T* p) const noexcept -> bool {
+        auto unit = _unit_of(p);
+        return (unit != _units) && (_allocated_orders[unit] != 0u);
+    }
+    
+    /**
+     * @return number of free blocks of the order
+     */
+    [[nodiscard]]
+    auto free_blocks (std::size_t order) const noexcept -> std::size_t {
+        return (order < orders_count) ? _free_count[order] : 0u;
+    }
+    
+    /**
+     * @return order of the block that serves nT Ts, nT must be in
+     *         [1, TPoolSize]
+     */
+    [[nodiscard]]
+    constexpr static auto order_of (std::size_t nT) noexcept -> std::size_t {
+        auto units = (nT + TMinBlockSize - 1u) / TMinBlockSize;
+        return static_cast<std::size_t>(
+            log2::greater_equal(std::size_t(units))
+        );
+    }
+    
+    /**
+     * @return size in Ts of the block that serves nT Ts
+     */
+    [[nodiscard]]
+    constexpr static auto block_size (std::size_t nT) noexcept
+    -> std::size_t {
+        auto units = (nT + TMinBlockSize - 1u) / TMinBlockSize;
+        return TMinBlockSize * pow2::greater_equal(std::size_t(units));
+    }
+
+private:
+    auto _deallocate_unit (std::size_t unit) noexcept -> void {
+        auto k = std::size_t(_allocated_orders[unit] - 1u);
+        _allocated_orders[unit] = 0u;
+        
+        auto i = unit >> k;
+        while (k + 1u != orders_count) { ///< O(logN) merges
+            auto buddy = i ^ 1u;
+            if (!_is_free(k, buddy)) {
+                break;
+            }
+            _clear(k, buddy);
+            i /= 2u;
+            ++k;
+        }
+        _give(k, i);
+    }
+    
+    [[nodiscard]]
+    auto _unit_of (const T* p) const noexcept -> std::size_t {
+        return beefy::_implementation::pool_index(
+            _pool_of_T, TMinBlockSize, _units, p
+        );
+    }
+    
+    /**
+     * @brief per order bitmap operations
+     */
+    [[nodiscard]]
+    auto _take (std::size_t k) noexcept -> std::size_t {
+        --_free_count[k];
+        return beefy::_implementation::bitmap_take(
+            _free_bits.data() + _bits_offsets[k],
+            _free_words.data() + _summary_offsets[k],
+            _units >> k
+        );
+    }
+    
+    auto _give (std::size_t k, std::size_t i) noexcept -> void {
+        ++_free_count[k];
+        beefy::_implementation::bitmap_give(
+            _free_bits.data() + _bits_offsets[k],
+            _free_words.data() + _summary_offsets[k],
+            i
+        );
+    }
+    
+    auto _clear (std::size_t k, std::size_t i) noexcept -> void {
+        --_free_count[k];
+        beefy::_implementation::bitmap_clear(
+            _free_bits.data() + _bits_offsets[k],
+            _free_words.data() + _summary_offsets[k],
+            i
+        );
+    }
+    
+    [[nodiscard]]
+    auto _is_free (std::size_t k, std::size_t i) const noexcept -> bool {
+        return beefy::_implementation::bitmap_test(
+            _free_bits.data() + _bits_offsets[k], i
+        );
+    }
+};
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_ALLOCATORS_BUDDY_HPP
@@ -0,0 +1,407 @@
+/** @file slab.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Object cache for a single type, slabs of objects are taken from
+ *         a beefy storage. Freed objects stay constructed.
+ *
+ * @details
+ *
+ *        Follows the slab allocator of J. Bonwick: an object is constructed
+ *        once, the first time its slot is handed out. destroy() doesn't run
+ *        the destructor, the object goes back to the cache as it is and the
+ *        next make() hands it out again without any initialisation. So an
+ *        object must be returned in its initial ('constructed') state, for
+ *        example a cleared buffer that keeps its capacity.
+ *        Destructors run only when the slab itself is released.
+ *
+ *        Every slab is a block of the backing storage: a header with the
+ *        owning cache, the occupancy, the stack of free slots and a bit per
+ *        slot that is set while its object is in use, then the objects.
+ *        A slab is found from an object pointer by the storage, so destroy()
+ *        is O(1). Only an allocated block whose header names this cache is
+ *        taken for a slab, the backing storage may be shared with other
+ *        caches or users. An object whose bit is clear is not in use,
+ *        destroying it again is ignored.
+ *
+ *        Slabs are kept in three lists by occupancy:
+ *        - partial -- objects are handed out from these first
+ *        - full
+ *        - empty -- released to the storage by reap()
+ *        A slab whose occupancy drops to a quarter is moved to the end of
+ *        the partial list, allocations then prefer fuller slabs and let the
+ *        nearly empty one drain and become reapable.
+ *
+ *        The cache is not synchronized.
+ *
+ * Usage example:
+ *
+ * static auto slabs = beefy::storage<std::byte, 16 * 1024, 64>();
+ * static auto connections = slab::cache<connection, 32, slabs>();
+ *
+ * auto c = connections.make(); ///< constructed only the first time
+ * ...
+ * c->reset();
+ * connections.destroy(c);
+ * connections.reap(); ///< give the empty slabs back
+ */
+
+#ifndef KCPPT_ALLOCATORS_SLAB_HPP
+#define KCPPT_ALLOCATORS_SLAB_HPP
+
+#include "beefy.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <utility>
+
+namespace kcppt {
+
+namespace allocators {
+
+namespace slab {
+
+/**
+ * @tparam T
+ * @tparam ObjectsPerSlab
+ * @tparam Backing -- beefy storage (not the base) with static storage
+ *         duration, its blocks hold the slabs
+ */
+template <typename T, std::size_t ObjectsPerSlab, auto& Backing>
+class cache {
+    static_assert(!std::is_void_v<T>);
+    static_assert(ObjectsPerSlab != 0u);
+
+private:
+    using backing_t = std::remove_reference_t<decltype(Backing)>;
+    using byte_t = std::remove_pointer_t<
+        decltype(Backing.allocate_block())
+    >;
+    using index_t = beefy::_implementation::least_uint_t<ObjectsPerSlab>;
+    using word_t = beefy::_implementation::bitmap_word_t;
+    
+    constexpr static auto _used_words =
+        beefy::_implementation::bitmap_words_count(ObjectsPerSlab);
+    
+    struct slab {
+        /**
+         * @brief the cache that made the slab, other blocks are not slabs
+         */
+        const cache* owner;
+        slab* prev;
+        slab* next;
+        /**
+         * @brief objects handed out
+         */
+        std::size_t in_use;
+        /**
+         * @brief slots [0, constructed) hold constructed objects
+         */
+        std::size_t constructed;
+        /**
+         * @brief free slots with constructed objects, a stack
+         */
+        std::size_t free_count;
+        index_t free_slots[ObjectsPerSlab];
+        /**
+         * @brief a set bit per slot whose object is handed out
+         */
+        word_t used[_used_words];
+        alignas(T) std::byte objects[ObjectsPerSlab * sizeof(T)];
+    };
+    
+    struct list {
+        slab* head;
+        slab* tail;
+    };
+    
+    static_assert(
+        backing_t::block_size_v * sizeof(byte_t) >= sizeof(slab),
+        "backing blocks are too small for the slab"
+    );
+    static_assert(
+        (backing_t::block_size_v * sizeof(byte_t)) % alignof(slab) == 0u,
+        "backing blocks are not aligned for the slab"
+    );
+    static_assert(alignof(slab) <= beefy::_implementation::cache_line_size);
+    
+    /**
+     * @brief occupancy at which the slab goes to the end of the partial list
+     */
+    constexpr static auto _low_water = ObjectsPerSlab / 4u;
+
+private:
+    list _partial;
+    list _full;
+    list _empty;
+    std::size_t _slabs_count;
+    std::size_t _in_use;
+
+public:
+    constexpr cache () noexcept :
+        _partial(),
+        _full(),
+        _empty(),
+        _slabs_count(0u),
+        _in_use(0u)
+    {}
+    
+    cache (const cache&) = delete;
+    auto operator= (const cache&) -> cache& = delete;
+    
+    /**
+     * @brief Every object is destroyed, even the ones in use
+     */
+    ~cache () noexcept {
+        for (auto l : {&_partial, &_full, &_empty}) {
+            while (l->head != nullptr) {
+                auto s = l->head;
+                _unlink(*l, s);
+                _release(s);
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Hand out a cached constructed object, or construct a new one
+     *        from 'args' if there are none
+     * @return nullptr if the backing storage is exhausted
+     */
+    template <typename...Args>
+    [[nodiscard]]
+    auto make (Args&&...args)
+    noexcept(std::is_nothrow_constructible_v<T, Args...>) -> T* {
+        auto s = (_partial.head != nullptr) ? _partial.head :
+                 (_empty.head != nullptr) ? _empty.head :
+                 _new_slab();
+        if (s == nullptr) {
+            return nullptr;
+        }
+        
+        auto i = std::size_t(0u);
+        if (s->free_count != 0u) {
+            i = s->free_slots[--s->free_count];
+        } else {
+            i = s->constructed;
+            new (_object(s, i)) T(std::forward<Args>(args)...);
+            ++s->constructed;
+        }
+        s->used[i / beefy::_implementation::bitmap_word_width] |=
+            beefy::_implementation::bitmap_bit(i);
+        
+        ++_in_use;
+        ++s->in_use;
+        if (s->in_use == ObjectsPerSlab) {
+            _unlink((s->in_use == 1u) ? _empty : _partial, s);
+            _push_front(_full, s);
+        } else if (s->in_use == 1u) {
+            _unlink(_empty, s);
+            _push_front(_partial, s);
+        }
+        return _object(s, i);
+    }
+    
+    /**
+     * @brief Give the object back to the cache, it stays constructed.
+     *        Pointers that are not objects of this cache, and objects that
+     *        are not in use (destroyed twice), are ignored.
+     */
+    auto destroy (T* p) noexcept -> void {
+        auto s = _slab_of(p);
+        if (s == nullptr) {
+            return;
+        }
+        auto i = _slot(s, p);
+        auto& word = s->used[i / beefy::_implementation::bitmap_word_width];
+        auto bit = beefy::_implementation::bitmap_bit(i);
+        if ((word & bit) == 0u) {
+            return;
+        }
+        word &= ~bit;
+        
+        s->free_slots[s->free_count++] = i;
+        --_in_use;
+        --s->in_use;
+        if (s->in_use + 1u == ObjectsPerSlab) {
+            _unlink(_full, s);
+            if (s->in_use == 0u) {
+                _push_front(_empty, s);
+            } else if (s->in_use <= _low_water) {
+                _push_back(_partial, s);
+            } else {
+                _push_front(_partial, s);
+            }
+        } else if (s->in_use == 0u) {
+            _unlink(_partial, s);
+            _push_front(_empty, s);
+        } else if (s->in_use == _low_water) {
+            _unlink(_partial, s);
+            _push_back(_partial, s);
+        }
+    }
+    
+    /**
+     * @brief Destroy the objects of the empty slabs and give the slabs back
+     *        to the backing storage
+     * @param keep -- number of empty slabs to keep for the next allocations
+     * @return number of the released slabs
+     */
+    auto reap (std::size_t keep = 0u) noexcept -> std::size_t {
+        auto kept = std::size_t(0u);
+        auto released = std::size_t(0u);
+        for (auto s = _empty.head; s != nullptr;) {
+            auto next = s->next;
+            if (kept == keep) {
+                _unlink(_empty, s);
+                _release(s);
+                ++released;
+            } else {
+                ++kept;
+            }
+            s = next;
+        }
+        return released;
+    }
+    
+    [[nodiscard]]
+    auto objects_in_use () const noexcept -> std::size_t {
+        return _in_use;
+    }
+    
+    [[nodiscard]]
+    auto slabs_count () const noexcept -> std::size_t {
+        return _slabs_count;
+    }
+    
+    /**
+     * @brief Call f(objects in use, ObjectsPerSlab) for every slab
+     */
+    template <typename F>
+    auto for_each_slab (F&& f) const -> void {
+        for (auto l : {&_full, &_partial, &_empty}) {
+            for (auto s = l->head; s != nullptr; s = s->next) {
+                f(s->in_use, ObjectsPerSlab);
+            }
+        }
+    }
+
+private:
+    [[nodiscard]]
+    auto _new_slab () noexcept -> slab* {
+        auto raw = Backing.allocate_block();
+        if (raw == nullptr) {
+            return nullptr;
+        }
+        auto s = new (raw) slab;
+        s->owner = this;
+        s->prev = nullptr;
+        s->next = nullptr;
+        s->in_use = 0u;
+        s->constructed = 0u;
+        s->free_count = 0u;
+        std::fill(std::begin(s->used), std::end(s->used), word_t(0u));
+        ++_slabs_count;
+        _push_front(_empty, s);
+        return s;
+    }
+    
+    auto _release (slab* s) noexcept -> void {
+        for (auto i : range::range(s->constructed)) {
+            _object(s, i)->~T();
+        }
+        s->owner = nullptr;
+        s->~slab();
+        --_slabs_count;
+        Backing.deallocate_block(reinterpret_cast<byte_t*>(s));
+    }
+    
+    [[nodiscard]]
+    auto _slab_of (const T* p) noexcept -> slab* {
+        auto block = Backing.block_of(reinterpret_cast<const byte_t*>(p));
+        /// a free block is not a slab, its header is not read at all
+        if ((block == nullptr) || !Backing.is_allocated(block)) {
+            return nullptr;
+        }
+        auto s = reinterpret_cast<slab*>(block);
+        if (s->owner != this) {
+            return nullptr;
+        }
+        auto offs = reinterpret_cast<std::uintptr_t>(p) -
+                    reinterpret_cast<std::uintptr_t>(s->objects);
+        if ((reinterpret_cast<const std::byte*>(p) < s->objects) ||
+            (offs % sizeof(T) != 0u) || (offs / sizeof(T) >= s->constructed)) {
+            return nullptr;
+        }
+        return s;
+    }
+    
+    [[nodiscard]]
+    static auto _object (slab* s, std::size_t i) noexcept -> T* {
+        return std::launder(reinterpret_cast<T*>(s->objects + i * sizeof(T)));
+    }
+    
+    [[nodiscard]]
+    static auto _slot (const slab* s, const T* p) noexcept -> index_t {
+        return static_cast<index_t>(
+            (reinterpret_cast<const std::byte*>(p) - s->objects) / sizeof(T)
+        );
+    }
+    
+    /**
+     * @brief intrusive doubly linked lists of slabs
+     */
+    static auto _unlink (list& l, slab* s) noexcept -> void {
+        (s->prev != nullptr ? s->prev->next : l.head) = s->next;
+        (s->next != nullptr ? s->next->prev : l.tail) = s->prev;
+        s->prev = nullptr;
+        s->next = nullptr;
+    }
+    
+    static auto _push_front (list& l, slab* s) noexcept -> void {
+        s->prev = nullptr;
+        s->next = l.head;
+        (l.head != nullptr ? l.head->prev : l.tail) = s;
+        l.head = s;
+    }
+    
+    static auto _push_back (list& l, slab* s) noexcept -> void {
+        s->next = nullptr;
+        s->prev = l.tail;
+        (l.tail != nullptr ? l.tail->next : l.head) = s;
+        l.tail = s;
+    }
+};
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_ALLOCATORS_SLAB_HPP
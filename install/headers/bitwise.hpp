@@ -34,6 +34,7 @@
 #define KCPPT_BITWISE_HPP
 
 #include <cinttypes>
+#include <climits>
 #include <type_traits>
 
 namespace kcppt {
@@ -52,6 +53,65 @@ constexpr auto rshift_count = [](T&& t) {
     return cnt;
 };
 
+/**
+ * @brief Number of zero bits below the lowest set bit.
+ *        Zero input has no set bits, the result is the bit width of T.
+ */
+template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+[[nodiscard]]
+constexpr auto count_trailing_zeros (T t) noexcept -> std::size_t {
+    if (t == 0u) {
+        return sizeof(T) * CHAR_BIT;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) <= sizeof(unsigned int)) {
+        return static_cast<std::size_t>(__builtin_ctz(t));
+    } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+        return static_cast<std::size_t>(__builtin_ctzl(t));
+    } else {
+        return static_cast<std::size_t>(__builtin_ctzll(t));
+    }
+#else
+    auto cnt = std::size_t(0u);
+    while ((t & 1u) == 0u) {
+        t >>= 1u;
+        ++cnt;
+    }
+    return cnt;
+#endif
+}
+
+/**
+ * @brief Number of zero bits above the highest set bit.
+ *        Zero input has no set bits, the result is the bit width of T.
+ */
+template <typename T, typename = std::enable_if_t<std::is_unsigned_v<T>>>
+[[nodiscard]]
+constexpr auto count_leading_zeros (T t) noexcept -> std::size_t {
+    if (t == 0u) {
+        return sizeof(T) * CHAR_BIT;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(T) <= sizeof(unsigned int)) {
+        /// narrow types are counted in the width of unsigned int
+        constexpr auto extra = (sizeof(unsigned int) - sizeof(T)) * CHAR_BIT;
+        return static_cast<std::size_t>(__builtin_clz(t)) - extra;
+    } else if constexpr (sizeof(T) <= sizeof(unsigned long)) {
+        return static_cast<std::size_t>(__builtin_clzl(t));
+    } else {
+        return static_cast<std::size_t>(__builtin_clzll(t));
+    }
+#else
+    auto cnt = std::size_t(0u);
+    constexpr auto top = T(T(1u) << (sizeof(T) * CHAR_BIT - 1u));
+    while ((t & top) == 0u) {
+        t <<= 1u;
+        ++cnt;
+    }
+    return cnt;
+#endif
+}
+
 
 }
 
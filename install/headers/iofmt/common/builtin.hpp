@@ -33,11 +33,23 @@
 #ifndef KCPPT_IOFMT_COMMON_BUILTIN_HPP
 #define KCPPT_IOFMT_COMMON_BUILTIN_HPP
 
+#include "dtoa.hpp"
+#include "sink.hpp"
+#include "../../bitwise.hpp"
+
+#include <array>
 #include <cinttypes>
+#include <cstring>
+#include <cwchar>
+#include <iterator>
 #include <type_traits>
 #include <utility>
 #include <climits>
 
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
 namespace kcppt {
 
 namespace iofmt {
@@ -62,11 +74,20 @@ using _slg = long;
 using _ulg = unsigned long;
 using _sll = long long;
 using _ull = unsigned long long;
+using _dbl = double;
 using ____ptr = void*;
 
 using __chptr = __ch*;
 using _wchptr = _wch*;
 
+/**
+ * @brief A double with the precision of its conversion, "%.3f"
+ */
+struct _dpr {
+    _dbl value;
+    std::size_t precision;
+};
+
 }
 
 namespace size {
@@ -85,6 +106,8 @@ constexpr static auto _slg = sizeof(type::_slg);
 constexpr static auto _ulg = sizeof(type::_ulg);
 constexpr static auto _sll = sizeof(type::_sll);
 constexpr static auto _ull = sizeof(type::_ull);
+constexpr static auto _dbl = sizeof(type::_dbl);
+constexpr static auto _dpr = sizeof(type::_dpr);
 
 constexpr static auto ____ptr = sizeof(type::____ptr);
 constexpr static auto __chptr = sizeof(type::__chptr);
@@ -92,20 +115,258 @@ constexpr static auto _wchptr = sizeof(type::_wchptr);
 
 }
 
+namespace _implementation {
+
+/**
+ * @brief "00", "01", ... "99", two decimal digits are rendered at once
+ */
+constexpr static auto decimal_pairs = [] {
+    std::array<char, 200u> ret {};
+    for (auto i = 0u; i < 100u; ++i) {
+        ret[i * 2u] = static_cast<char>('0' + i / 10u);
+        ret[i * 2u + 1u] = static_cast<char>('0' + i % 10u);
+    }
+    return ret;
+}();
+
+constexpr static std::uint64_t powers_of_10[20u] {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u,
+    100000000u, 1000000000u, 10000000000u, 100000000000u,
+    1000000000000u, 10000000000000u, 100000000000000u,
+    1000000000000000u, 10000000000000000u, 100000000000000000u,
+    1000000000000000000u, 10000000000000000000u
+};
+
+/**
+ * @brief Number of decimal digits of 'v': the bit width of 'v' times
+ *        log10(2) (1233 / 4096) is the count or one more than the count
+ */
+[[nodiscard]]
+constexpr static auto decimal_digits_count (std::uint64_t v) noexcept
+-> std::size_t {
+    v |= 1u; ///< zero has a single digit, powers of 10 from 10 are even
+    auto bits = 64u - bitwise::count_leading_zeros(v);
+    auto t = (bits * 1233u) >> 12u;
+    return t + 1u - static_cast<std::size_t>(v < powers_of_10[t]);
+}
+
+constexpr static auto put_decimal_pair (char* p, std::uint32_t pair) noexcept {
+    p[0u] = decimal_pairs[pair * 2u];
+    p[1u] = decimal_pairs[pair * 2u + 1u];
+}
+
+/**
+ * @brief Digits of a 32-bit value, written right to left up to 'end'
+ */
+constexpr static auto put_decimal_u32 (char* end, std::uint32_t v) noexcept {
+    while (v >= 100u) {
+        end -= 2u;
+        put_decimal_pair(end, v % 100u);
+        v /= 100u;
+    }
+    if (v >= 10u) {
+        put_decimal_pair(end - 2u, v);
+    } else {
+        end[-1] = static_cast<char>('0' + v);
+    }
+}
+
+/**
+ * @brief Exactly 8 digits with the leading zeros, right to left up to 'end'
+ */
+constexpr static auto put_decimal_8 (char* end, std::uint32_t v) noexcept {
+    for (auto i = 0u; i < 4u; ++i) {
+        end -= 2u;
+        put_decimal_pair(end, v % 100u);
+        v /= 100u;
+    }
+}
+
+/**
+ * @brief Write the decimal digits of 'v' starting at 'out', there must be
+ *        room for 20 characters. The count is known up front, so the digits
+ *        are put right to left into their places with no reversal.
+ *        64-bit values are split into 8-digit parts by at most two 64-bit
+ *        divisions by a constant, the parts are rendered with 32-bit ones.
+ * @return past the last digit
+ */
+constexpr static auto to_decimal (char* out, std::uint64_t v) noexcept
+-> char* {
+    auto end = out + decimal_digits_count(v);
+    auto p = end;
+    while (v > UINT32_MAX) {
+        put_decimal_8(p, static_cast<std::uint32_t>(v % 100000000u));
+        v /= 100000000u;
+        p -= 8u;
+    }
+    put_decimal_u32(p, static_cast<std::uint32_t>(v));
+    return end;
+}
+
+/**
+ * @brief "00", "01", ... "77", two octal digits (6 bits) are rendered at once
+ */
+constexpr static auto octal_pairs = [] {
+    std::array<char, 128u> ret {};
+    for (auto i = 0u; i < 64u; ++i) {
+        ret[i * 2u] = static_cast<char>('0' + i / 8u);
+        ret[i * 2u + 1u] = static_cast<char>('0' + i % 8u);
+    }
+    return ret;
+}();
+
+/**
+ * @brief Write the octal digits of 'v' starting at 'out', there must be
+ *        room for 22 characters. Same as 'to_decimal', the count is taken
+ *        from the bit width and the digits are put right to left in pairs.
+ * @return past the last digit
+ */
+constexpr static auto to_octal (char* out, std::uint64_t v) noexcept
+-> char* {
+    auto n = (64u - bitwise::count_leading_zeros(v | 1u) + 2u) / 3u;
+    auto end = out + n;
+    auto p = end;
+    for (; n >= 2u; n -= 2u) {
+        p -= 2u;
+        p[0u] = octal_pairs[(v & 63u) * 2u];
+        p[1u] = octal_pairs[(v & 63u) * 2u + 1u];
+        v >>= 6u;
+    }
+    if (n != 0u) {
+        p[-1] = static_cast<char>('0' + v);
+    }
+    return end;
+}
+
+constexpr static char hex_digits_lower[] = "0123456789abcdef";
+constexpr static char hex_digits_upper[] = "0123456789ABCDEF";
+
+[[nodiscard]]
+constexpr static auto hex_digits_count (std::uint64_t v) noexcept
+-> std::size_t {
+    return (64u - bitwise::count_leading_zeros(v | 1u) + 3u) / 4u;
+}
+
+/**
+ * @brief Nibble 'i' of 'x' goes to byte 'i' of the result
+ */
+[[nodiscard]]
+constexpr static auto spread_nibbles (std::uint32_t x) noexcept
+-> std::uint64_t {
+    auto r = std::uint64_t(x);
+    r = (r | (r << 16u)) & 0x0000FFFF0000FFFFu;
+    r = (r | (r << 8u)) & 0x00FF00FF00FF00FFu;
+    r = (r | (r << 4u)) & 0x0F0F0F0F0F0F0F0Fu;
+    return r;
+}
+
+/**
+ * @brief Every byte of 'r' is a nibble, all 8 are made hex digits at once:
+ *        '0' is added to every byte, and the distance from '9' + 1 to 'a'
+ *        or 'A' is added to the bytes that are 10 or more
+ */
+[[nodiscard]]
+constexpr static auto nibbles_to_hex (std::uint64_t r, bool uppercase) noexcept
+-> std::uint64_t {
+    constexpr auto ones = std::uint64_t(0x0101010101010101u);
+    auto ge10 = ((r + ones * 6u) >> 4u) & ones;
+    return r + ones * 0x30u + ge10 * (uppercase ? 0x07u : 0x27u);
+}
+
+/**
+ * @brief Byte 7 of 'r' goes to p[0], byte 0 to p[7]
+ */
+constexpr static auto put_bytes_msb_first (char* p, std::uint64_t r) noexcept {
+    for (auto i = 0u; i < 8u; ++i) {
+        p[i] = static_cast<char>(r >> (56u - i * 8u));
+    }
+}
+
+/**
+ * @brief Exactly 16 hex digits of 'v' with the leading zeros
+ */
+static auto put_hex_16 (char* p, std::uint64_t v, bool uppercase) noexcept {
+#if defined(__SSSE3__)
+    auto digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        uppercase ? hex_digits_upper : hex_digits_lower
+    ));
+    auto mask = _mm_set1_epi8(0x0F);
+    auto x = _mm_set_epi64x(0, static_cast<long long>(v));
+    auto lo = _mm_and_si128(x, mask);
+    auto hi = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+    /// high nibble first in every byte, then the most significant byte first
+    auto nibbles = _mm_shuffle_epi8(
+        _mm_unpacklo_epi8(hi, lo),
+        _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1)
+    );
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(p), _mm_shuffle_epi8(digits, nibbles)
+    );
+#else
+    put_bytes_msb_first(p, nibbles_to_hex(
+        spread_nibbles(static_cast<std::uint32_t>(v >> 32u)), uppercase
+    ));
+    put_bytes_msb_first(p + 8u, nibbles_to_hex(
+        spread_nibbles(static_cast<std::uint32_t>(v)), uppercase
+    ));
+#endif
+}
+
+/**
+ * @brief Two hex digits for every byte of [b, b + n), in the memory order
+ *        of the bytes. Writes 2 * n characters.
+ */
+static inline auto put_hex_bytes (
+    char* p, const unsigned char* b, std::size_t n, bool uppercase
+) noexcept {
+#if defined(__SSSE3__)
+    auto digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        uppercase ? hex_digits_upper : hex_digits_lower
+    ));
+    auto mask = _mm_set1_epi8(0x0F);
+    for (; n >= 16u; n -= 16u, b += 16u, p += 32u) {
+        auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        auto lo = _mm_and_si128(x, mask);
+        auto hi = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(p),
+            _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(hi, lo))
+        );
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(p + 16u),
+            _mm_shuffle_epi8(digits, _mm_unpackhi_epi8(hi, lo))
+        );
+    }
+#endif
+    for (; n >= 8u; n -= 8u, b += 8u, p += 16u) {
+        /// the bytes are read most significant first, so the memory order
+        /// is kept on any endianness
+        auto v = std::uint64_t(0u);
+        for (auto i = 0u; i < 8u; ++i) {
+            v = (v << 8u) | b[i];
+        }
+        put_hex_16(p, v, uppercase);
+    }
+    auto digits_of = uppercase ? hex_digits_upper : hex_digits_lower;
+    for (; n != 0u; --n, ++b, p += 2u) {
+        p[0u] = digits_of[*b >> 4u];
+        p[1u] = digits_of[*b & 15u];
+    }
+}
+
+}
+
 namespace out {
 
 template <typename PutcFunctor, const PutcFunctor& putc>
 class ascii {
 public:
     static auto character (char c) noexcept {
-        putc(c);
+        sink::put(putc, c);
     }
     
     static auto string (const char* s) noexcept {
-        while (*s != '\0') {
-            putc(*s);
-            ++s;
-        }
+        sink::write(putc, s, std::strlen(s));
     }
 };
 
@@ -119,20 +380,8 @@ private:
         /******************************/
         /// u64, aka unsigned long long takes at most 20 decimal symbols
         char decdigits[20u];
-        auto sz = std::size_t(0u);
-        auto min = false;
-        
-        if (i == 0u) { /// if already zero
-            decdigits[sz++] = 0x30u;
-        } else {
-            while (i != 0u) {
-                decdigits[sz++] = static_cast<char>((i % 10u) + 0x30u);
-                i /= 10u;
-            }
-        }
-        while (sz != 0u) {
-            putc(decdigits[--sz]);
-        }
+        auto e = _implementation::to_decimal(decdigits, i);
+        sink::write(putc, decdigits, static_cast<std::size_t>(e - decdigits));
     }
     
     template <
@@ -143,87 +392,59 @@ private:
         /// s64, aka signed   long long takes at most 19 decimal symbols
         /// plus the '-' sign if negative
         char decdigits[20u];
-        auto sz = std::size_t(0u);
-        
-        if (i == 0u) { /// if already zero
-            decdigits[sz++] = 0x30u;
-        } else {
-            auto min = false;
-            auto neg = false;
-            
-            if (i < 0) {
-                neg = true;
-                /// comparison between signed and unsigned
-//                    long long i_hack_from_warning = i;
-                if (i == LLONG_MIN) {
-                    min = true;
-                    ++i *= (-1);
-                } else {
-                    i = -i;
-                }
-            }
-            
-            while (i != 0u) {
-                decdigits[sz++] = static_cast<char>((i % 10u) + 0x30u);
-                i /= 10u;
-            }
-            
-            if (neg) {
-                if (!ignore_sign) {
-                    decdigits[sz++] = '-';
-                }
-                if (min) {
-                    ++decdigits[0u];
-                }
-            }
-            
+        /// negated as unsigned, so the minimal value needs no special case
+        auto u = static_cast<std::make_unsigned_t<T>>(i);
+        if (i < 0) {
+            u = 0u - u;
         }
-        
-        while (sz != 0u) {
-            putc(decdigits[--sz]);
+        auto b = decdigits;
+        if ((i < 0) && !ignore_sign) {
+            *b++ = '-';
         }
+        auto e = _implementation::to_decimal(b, u);
+        sink::write(putc, decdigits, static_cast<std::size_t>(e - decdigits));
     }
     
     static auto _octal (unsigned long long o) noexcept {
         /// u64, aka unsigned long long takes at most 22 octal symbols
         char octdigits[22u];
-        auto sz = std::size_t(0u);
-        if (o == 0u) {
-            octdigits[0u] = '0';
-            sz = 1u;
-        }
-        while (o != 0u) {
-            octdigits[sz++] = static_cast<char>((o & 7u) + 0x30u);
-            o >>= 3u;
-        }
-        while (sz != 0u) {
-            putc(octdigits[--sz]);
-        }
+        auto e = _implementation::to_octal(octdigits, o);
+        sink::write(putc, octdigits, static_cast<std::size_t>(e - octdigits));
     }
     
     enum class hex_case_t : bool {
         lower, upper
     };
     
+    /**
+     * @brief All 16 digits are rendered at once, the case is picked once,
+     *        the leading zeros are skipped by the digits count
+     */
     static auto _hexadecimal (
         unsigned long long x, hex_case_t hcase = hex_case_t::lower
     ) noexcept {
         // u64, aka unsigned long long takes at most 16 hexadecimal symbols
         char hexdigits[16u];
-        auto sz = std::size_t(0u);
-        if (x == 0u) {
-            hexdigits[0u] = '0';
-            sz = 1u;
-        }
-        auto lowercase = (hcase == hex_case_t::lower);
-        while (x != 0u) {
-            auto num = x & 15u;
-            auto offs = (num <= 9u) ? 0x30u : lowercase ? 0x57u : 0x37u;
-            hexdigits[sz++] = static_cast<char>(num + offs);
-            x >>= 4u;
-        }
-        while (sz != 0u) {
-            putc(hexdigits[--sz]);
+        _implementation::put_hex_16(hexdigits, x, hcase == hex_case_t::upper);
+        auto n = _implementation::hex_digits_count(x);
+        sink::write(putc, std::end(hexdigits) - n, n);
+    }
+    
+    static auto _hexdump (
+        const void* data, std::size_t size, hex_case_t hcase
+    ) noexcept {
+        /// rendered by chunks of a local buffer, every chunk is a single span
+        constexpr auto chunk = std::size_t(128u);
+        char hexdigits[chunk * 2u];
+        auto b = static_cast<const unsigned char*>(data);
+        while (size != 0u) {
+            auto n = (size < chunk) ? size : chunk;
+            _implementation::put_hex_bytes(
+                hexdigits, b, n, hcase == hex_case_t::upper
+            );
+            sink::write(putc, hexdigits, n * 2u);
+            b += n;
+            size -= n;
         }
     }
 
@@ -262,13 +483,59 @@ public:
     static auto hexadecimal_uppercase (unsigned long long X) noexcept {
         _hexadecimal(X, hex_case_t::upper);
     }
+    
+    /**
+     * @brief Two hex digits for every byte of the buffer, in memory order,
+     *        with no separators
+     */
+    static auto hexdump_lowercase (const void* data, std::size_t size)
+    noexcept {
+        _hexdump(data, size, hex_case_t::lower);
+    }
+    
+    static auto hexdump_uppercase (const void* data, std::size_t size)
+    noexcept {
+        _hexdump(data, size, hex_case_t::upper);
+    }
 
 };
 
 template <typename PutcFunctor, const PutcFunctor& putc>
 class floats {
-public:
+private:
+    static auto _write (const char* s, std::size_t n) noexcept {
+        sink::write(putc, s, n);
+    }
 
+public:
+    /**
+     * @brief Shortest characters that read back as the same value
+     */
+    static auto shortest (float v) noexcept {
+        char buf[dtoa::shortest_size];
+        auto e = dtoa::to_shortest(buf, v);
+        sink::write(putc, buf, static_cast<std::size_t>(e - buf));
+    }
+    
+    static auto shortest (double v) noexcept {
+        char buf[dtoa::shortest_size];
+        auto e = dtoa::to_shortest(buf, v);
+        sink::write(putc, buf, static_cast<std::size_t>(e - buf));
+    }
+    
+    /**
+     * @brief "%.Nf", exact and rounded half to even
+     */
+    static auto fixed_lowercase (double v, std::size_t precision) noexcept {
+        dtoa::to_fixed(_write, v, precision, false);
+    }
+    
+    /**
+     * @brief "%.NF", same as "%.Nf" but "INF" and "NAN"
+     */
+    static auto fixed_uppercase (double v, std::size_t precision) noexcept {
+        dtoa::to_fixed(_write, v, precision, true);
+    }
 };
 
 }
@@ -276,13 +543,13 @@ public:
 namespace inp {
 
 }
-    
+
 }
-    
+
 }
 
 }
-    
+
 }
-    
+
 #endif /// KCPPT_IOFMT_COMMON_BUILTIN_HPP
@@ -79,6 +79,16 @@ namespace type {
     using ___u = builtin::type::_uin;
     using __lu = builtin::type::_ulg;
     using _llu = builtin::type::_ull;
+    using _hhf = builtin::type::_n_a;
+    using __hf = builtin::type::_n_a;
+    using ___f = builtin::type::_dpr;
+    using __lf = builtin::type::_dpr;
+    using _llf = builtin::type::_n_a;
+    using _hhF = builtin::type::_n_a;
+    using __hF = builtin::type::_n_a;
+    using ___F = builtin::type::_dpr;
+    using __lF = builtin::type::_dpr;
+    using _llF = builtin::type::_n_a;
 };
 
 namespace size {
@@ -117,6 +127,16 @@ namespace size {
     constexpr static auto ___u = builtin::size::_uin;
     constexpr static auto __lu = builtin::size::_ulg;
     constexpr static auto _llu = builtin::size::_ull;
+    constexpr static auto _hhf = builtin::size::_n_a;
+    constexpr static auto __hf = builtin::size::_n_a;
+    constexpr static auto ___f = builtin::size::_dpr;
+    constexpr static auto __lf = builtin::size::_dpr;
+    constexpr static auto _llf = builtin::size::_n_a;
+    constexpr static auto _hhF = builtin::size::_n_a;
+    constexpr static auto __hF = builtin::size::_n_a;
+    constexpr static auto ___F = builtin::size::_dpr;
+    constexpr static auto __lF = builtin::size::_dpr;
+    constexpr static auto _llF = builtin::size::_n_a;
 };
 
 namespace out {
@@ -318,6 +338,46 @@ class floats {
 private:
     using out_t = builtin::out::floats<PutcFunctor, putc>;
 
+public:
+    /// float arguments are promoted to double, 'l' changes nothing
+    static auto _hhf (const void* pmem) noexcept {
+        (void)pmem;
+    }
+    static auto __hf (const void* pmem) noexcept {
+        (void)pmem;
+    }
+    static auto ___f (const void* pmem) noexcept {
+        using type = conversion::type::___f;
+        auto tmp = *reinterpret_cast<const type*>(pmem);
+        out_t::fixed_lowercase(tmp.value, tmp.precision);
+    }
+    static auto __lf (const void* pmem) noexcept {
+        using type = conversion::type::__lf;
+        auto tmp = *reinterpret_cast<const type*>(pmem);
+        out_t::fixed_lowercase(tmp.value, tmp.precision);
+    }
+    static auto _llf (const void* pmem) noexcept {
+        (void)pmem;
+    }
+    static auto _hhF (const void* pmem) noexcept {
+        (void)pmem;
+    }
+    static auto __hF (const void* pmem) noexcept {
+        (void)pmem;
+    }
+    static auto ___F (const void* pmem) noexcept {
+        using type = conversion::type::___F;
+        auto tmp = *reinterpret_cast<const type*>(pmem);
+        out_t::fixed_uppercase(tmp.value, tmp.precision);
+    }
+    static auto __lF (const void* pmem) noexcept {
+        using type = conversion::type::__lF;
+        auto tmp = *reinterpret_cast<const type*>(pmem);
+        out_t::fixed_uppercase(tmp.value, tmp.precision);
+    }
+    static auto _llF (const void* pmem) noexcept {
+        (void)pmem;
+    }
 };
 
 }
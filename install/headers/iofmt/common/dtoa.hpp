@@ -0,0 +1,754 @@
+/** @file dtoa.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Conversion of floating point values to decimal characters: the
+ *         shortest form that reads back as the same value, and the fixed
+ *         form with a given number of digits after the point ("%.Nf").
+ *
+ * @details
+ *
+ *        The shortest form is made by Grisu2 (F. Loitsch, "Printing
+ *        Floating-Point Numbers Quickly and Accurately with Integers"):
+ *        the value and the boundaries of its rounding interval are scaled
+ *        by a cached power of 10 into 64-bit integers, and the digits are
+ *        generated until they identify the value within the interval.
+ *        The result always reads back as the same value. It is the
+ *        shortest one for all but a fraction of a percent of the inputs,
+ *        mostly those whose shortest form lies right on a bound of the
+ *        interval (then it is a digit or two longer). Floats are converted
+ *        with their own interval, so 0.1f is "0.1", not
+ *        "0.10000000149011612".
+ *        Values with the decimal exponent in [-4, 16) are written as
+ *        "123.45" (always with a point), the rest as "1.2345e+300".
+ *
+ *        The fixed form is exact and rounded half to even, same as the
+ *        one of glibc printf: the value times 10^N is computed as a
+ *        big integer and rounded, the digits of it are put around the
+ *        point. The digits beyond the exact expansion of the value are
+ *        zeros and are not computed.
+ *
+ *        Neither uses the heap, the stack is bounded: about 32 bytes for
+ *        the shortest form, under 1 KiB for the fixed one (the expansion of
+ *        the least denormal takes 1074 digits).
+ *
+ * Usage example:
+ *
+ * char buf[dtoa::shortest_size];
+ * auto e = dtoa::to_shortest(buf, 0.3); ///< "0.3"
+ *
+ * dtoa::to_fixed(out, 2.5, 0u, false); ///< out("2", 1u)
+ */
+
+#ifndef KCPPT_IOFMT_COMMON_DTOA_HPP
+#define KCPPT_IOFMT_COMMON_DTOA_HPP
+
+#include "../../bitwise.hpp"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace kcppt {
+
+namespace iofmt {
+
+namespace common {
+
+namespace dtoa {
+
+namespace _implementation {
+
+static_assert(std::numeric_limits<double>::is_iec559);
+static_assert(std::numeric_limits<float>::is_iec559);
+
+/**
+ * @brief f * 2^e, with no implicit bit
+ */
+struct diy_fp {
+    std::uint64_t f;
+    int e;
+};
+
+[[nodiscard]]
+constexpr static auto sub (diy_fp x, diy_fp y) noexcept -> diy_fp {
+    return {x.f - y.f, x.e};
+}
+
+/**
+ * @brief Upper 64 bits of the 128-bit product, rounded
+ */
+[[nodiscard]]
+constexpr static auto mul (diy_fp x, diy_fp y) noexcept -> diy_fp {
+    auto x_lo = x.f & 0xFFFFFFFFu;
+    auto x_hi = x.f >> 32u;
+    auto y_lo = y.f & 0xFFFFFFFFu;
+    auto y_hi = y.f >> 32u;
+    
+    auto p0 = x_lo * y_lo;
+    auto p1 = x_lo * y_hi;
+    auto p2 = x_hi * y_lo;
+    auto p3 = x_hi * y_hi;
+    
+    auto q = (p0 >> 32u) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+    q += std::uint64_t(1u) << 31u; ///< round
+    return {p3 + (p1 >> 32u) + (p2 >> 32u) + (q >> 32u), x.e + y.e + 64};
+}
+
+[[nodiscard]]
+constexpr static auto normalize (diy_fp x) noexcept -> diy_fp {
+    auto shift = bitwise::count_leading_zeros(x.f);
+    return {x.f << shift, x.e - static_cast<int>(shift)};
+}
+
+/**
+ * @brief The significand and the binary exponent of a positive value,
+ *        denormals included
+ */
+template <typename F>
+[[nodiscard]]
+static auto decompose (F value) noexcept -> diy_fp {
+    static_assert(std::is_same_v<F, float> || std::is_same_v<F, double>);
+    using bits_t = std::conditional_t<
+        std::is_same_v<F, float>, std::uint32_t, std::uint64_t
+    >;
+    constexpr auto digits = std::numeric_limits<F>::digits;
+    constexpr auto bias = std::numeric_limits<F>::max_exponent - 1 +
+                          (digits - 1);
+    constexpr auto hidden_bit = std::uint64_t(1u) << (digits - 1);
+    
+    auto bits = bits_t(0u);
+    std::memcpy(&bits, &value, sizeof(bits));
+    auto e = static_cast<int>(std::uint64_t(bits) >> (digits - 1));
+    auto f = std::uint64_t(bits) & (hidden_bit - 1u);
+    if (e == 0) {
+        return {f, 1 - bias};
+    }
+    return {f + hidden_bit, e - bias};
+}
+
+/**
+ * @brief The value and the bounds of the interval of the reals that round
+ *        to it, both bounds have the same exponent
+ */
+struct boundaries {
+    diy_fp w;
+    diy_fp minus;
+    diy_fp plus;
+};
+
+template <typename F>
+[[nodiscard]]
+static auto compute_boundaries (F value) noexcept -> boundaries {
+    constexpr auto digits = std::numeric_limits<F>::digits;
+    constexpr auto hidden_bit = std::uint64_t(1u) << (digits - 1);
+    constexpr auto min_exp = 2 - std::numeric_limits<F>::max_exponent -
+                             (digits - 1);
+    
+    auto v = decompose(value);
+    /// the lower neighbour is closer for the powers of 2, but the least
+    /// normal value, its lower neighbours are denormals with the same step
+    auto lower_is_closer = (v.f == hidden_bit) && (v.e > min_exp);
+    auto plus = normalize(diy_fp{v.f * 2u + 1u, v.e - 1});
+    auto minus = lower_is_closer ?
+        diy_fp{v.f * 4u - 1u, v.e - 2} :
+        diy_fp{v.f * 2u - 1u, v.e - 1};
+    minus.f <<= (minus.e - plus.e);
+    minus.e = plus.e;
+    return {normalize(v), minus, plus};
+}
+
+/**
+ * @brief The scaled values have the binary exponent in [alpha, gamma], so
+ *        the integral part of M_plus fits 32 bits
+ */
+constexpr static auto alpha = -60;
+constexpr static auto gamma = -32;
+
+struct cached_power {
+    std::uint64_t f;
+    int e;
+    int k;
+};
+
+/**
+ * @brief 10^k for k = -300, -292, ... 324, normalized and rounded
+ */
+constexpr static cached_power cached_powers[] {
+    {0xAB70FE17C79AC6CAu, -1060, -300},
+    {0xFF77B1FCBEBCDC4Fu, -1034, -292},
+    {0xBE5691EF416BD60Cu, -1007, -284},
+    {0x8DD01FAD907FFC3Cu,  -980, -276},
+    {0xD3515C2831559A83u,  -954, -268},
+    {0x9D71AC8FADA6C9B5u,  -927, -260},
+    {0xEA9C227723EE8BCBu,  -901, -252},
+    {0xAECC49914078536Du,  -874, -244},
+    {0x823C12795DB6CE57u,  -847, -236},
+    {0xC21094364DFB5637u,  -821, -228},
+    {0x9096EA6F3848984Fu,  -794, -220},
+    {0xD77485CB25823AC7u,  -768, -212},
+    {0xA086CFCD97BF97F4u,  -741, -204},
+    {0xEF340A98172AACE5u,  -715, -196},
+    {0xB23867FB2A35B28Eu,  -688, -188},
+    {0x84C8D4DFD2C63F3Bu,  -661, -180},
+    {0xC5DD44271AD3CDBAu,  -635, -172},
+    {0x936B9FCEBB25C996u,  -608, -164},
+    {0xDBAC6C247D62A584u,  -582, -156},
+    {0xA3AB66580D5FDAF6u,  -555, -148},
+    {0xF3E2F893DEC3F126u,  -529, -140},
+    {0xB5B5ADA8AAFF80B8u,  -502, -132},
+    {0x87625F056C7C4A8Bu,  -475, -124},
+    {0xC9BCFF6034C13053u,  -449, -116},
+    {0x964E858C91BA2655u,  -422, -108},
+    {0xDFF9772470297EBDu,  -396, -100},
+    {0xA6DFBD9FB8E5B88Fu,  -369,  -92},
+    {0xF8A95FCF88747D94u,  -343,  -84},
+    {0xB94470938FA89BCFu,  -316,  -76},
+    {0x8A08F0F8BF0F156Bu,  -289,  -68},
+    {0xCDB02555653131B6u,  -263,  -60},
+    {0x993FE2C6D07B7FACu,  -236,  -52},
+    {0xE45C10C42A2B3B06u,  -210,  -44},
+    {0xAA242499697392D3u,  -183,  -36},
+    {0xFD87B5F28300CA0Eu,  -157,  -28},
+    {0xBCE5086492111AEBu,  -130,  -20},
+    {0x8CBCCC096F5088CCu,  -103,  -12},
+    {0xD1B71758E219652Cu,   -77,   -4},
+    {0x9C40000000000000u,   -50,    4},
+    {0xE8D4A51000000000u,   -24,   12},
+    {0xAD78EBC5AC620000u,     3,   20},
+    {0x813F3978F8940984u,    30,   28},
+    {0xC097CE7BC90715B3u,    56,   36},
+    {0x8F7E32CE7BEA5C70u,    83,   44},
+    {0xD5D238A4ABE98068u,   109,   52},
+    {0x9F4F2726179A2245u,   136,   60},
+    {0xED63A231D4C4FB27u,   162,   68},
+    {0xB0DE65388CC8ADA8u,   189,   76},
+    {0x83C7088E1AAB65DBu,   216,   84},
+    {0xC45D1DF942711D9Au,   242,   92},
+    {0x924D692CA61BE758u,   269,  100},
+    {0xDA01EE641A708DEAu,   295,  108},
+    {0xA26DA3999AEF774Au,   322,  116},
+    {0xF209787BB47D6B85u,   348,  124},
+    {0xB454E4A179DD1877u,   375,  132},
+    {0x865B86925B9BC5C2u,   402,  140},
+    {0xC83553C5C8965D3Du,   428,  148},
+    {0x952AB45CFA97A0B3u,   455,  156},
+    {0xDE469FBD99A05FE3u,   481,  164},
+    {0xA59BC234DB398C25u,   508,  172},
+    {0xF6C69A72A3989F5Cu,   534,  180},
+    {0xB7DCBF5354E9BECEu,   561,  188},
+    {0x88FCF317F22241E2u,   588,  196},
+    {0xCC20CE9BD35C78A5u,   614,  204},
+    {0x98165AF37B2153DFu,   641,  212},
+    {0xE2A0B5DC971F303Au,   667,  220},
+    {0xA8D9D1535CE3B396u,   694,  228},
+    {0xFB9B7CD9A4A7443Cu,   720,  236},
+    {0xBB764C4CA7A44410u,   747,  244},
+    {0x8BAB8EEFB6409C1Au,   774,  252},
+    {0xD01FEF10A657842Cu,   800,  260},
+    {0x9B10A4E5E9913129u,   827,  268},
+    {0xE7109BFBA19C0C9Du,   853,  276},
+    {0xAC2820D9623BF429u,   880,  284},
+    {0x80444B5E7AA7CF85u,   907,  292},
+    {0xBF21E44003ACDD2Du,   933,  300},
+    {0x8E679C2F5E44FF8Fu,   960,  308},
+    {0xD433179D9C8CB841u,   986,  316},
+    {0x9E19DB92B4E31BA9u,  1013,  324},
+};
+
+/**
+ * @brief c = 10^-k, such that alpha <= e + c.e + 64 <= gamma
+ */
+[[nodiscard]]
+constexpr static auto get_cached_power (int e) noexcept -> cached_power {
+    constexpr auto min_decimal_exponent = -300;
+    constexpr auto decimal_step = 8;
+    
+    auto f = alpha - e - 1;
+    /// ceil(f * log10(2))
+    auto k = (f * 78913) / (1 << 18) + static_cast<int>(f > 0);
+    auto i = (k - min_decimal_exponent + decimal_step - 1) / decimal_step;
+    return cached_powers[i];
+}
+
+/**
+ * @brief Move the last digit down while the result gets closer to 'w'
+ *        and stays in the interval
+ */
+constexpr static auto grisu2_round (
+    char* buf, int len, std::uint64_t dist, std::uint64_t delta,
+    std::uint64_t rest, std::uint64_t ten_k
+) noexcept {
+    while ((rest < dist) && (delta - rest >= ten_k) &&
+           ((rest + ten_k < dist) || (dist - rest > rest + ten_k - dist))) {
+        --buf[len - 1];
+        rest += ten_k;
+    }
+}
+
+/**
+ * @brief Digits of M_plus until they are within M_plus - M_minus
+ */
+constexpr static auto grisu2_digit_gen (
+    char* buf, int& len, int& decimal_exponent,
+    diy_fp m_minus, diy_fp w, diy_fp m_plus
+) noexcept {
+    auto delta = sub(m_plus, m_minus).f;
+    auto dist = sub(m_plus, w).f;
+    
+    auto shift = static_cast<unsigned>(-m_plus.e);
+    auto one = std::uint64_t(1u) << shift;
+    auto p1 = static_cast<std::uint32_t>(m_plus.f >> shift);
+    auto p2 = m_plus.f & (one - 1u);
+    
+    auto pow10 = std::uint32_t(1u);
+    auto n = 1;
+    while (p1 / pow10 >= 10u) {
+        pow10 *= 10u;
+        ++n;
+    }
+    
+    /// integral part
+    while (n > 0) {
+        buf[len++] = static_cast<char>('0' + p1 / pow10);
+        p1 %= pow10;
+        --n;
+        auto rest = (std::uint64_t(p1) << shift) + p2;
+        if (rest <= delta) {
+            decimal_exponent += n;
+            grisu2_round(
+                buf, len, dist, delta, rest, std::uint64_t(pow10) << shift
+            );
+            return;
+        }
+        pow10 /= 10u;
+    }
+    
+    /// fractional part
+    auto m = 0;
+    do {
+        p2 *= 10u;
+        buf[len++] = static_cast<char>('0' + (p2 >> shift));
+        p2 &= one - 1u;
+        delta *= 10u;
+        dist *= 10u;
+        ++m;
+    } while (p2 > delta);
+    decimal_exponent -= m;
+    grisu2_round(buf, len, dist, delta, p2, one);
+}
+
+/**
+ * @brief Digits of a positive finite value, it is buf * 10^decimal_exponent
+ */
+template <typename F>
+static auto grisu2 (char* buf, int& len, int& decimal_exponent, F value)
+noexcept {
+    auto b = compute_boundaries(value);
+    auto cached = get_cached_power(b.plus.e);
+    auto c = diy_fp{cached.f, cached.e};
+    
+    auto w = mul(b.w, c);
+    auto w_minus = mul(b.minus, c);
+    auto w_plus = mul(b.plus, c);
+    /// the products are rounded, the interval is narrowed by one unit on
+    /// each side to stay inside the exact one
+    auto m_minus = diy_fp{w_minus.f + 1u, w_minus.e};
+    auto m_plus = diy_fp{w_plus.f - 1u, w_plus.e};
+    
+    len = 0;
+    decimal_exponent = -cached.k;
+    grisu2_digit_gen(buf, len, decimal_exponent, m_minus, w, m_plus);
+}
+
+/**
+ * @brief 'e' and the exponent, with the sign and at least 2 digits
+ */
+constexpr static auto append_exponent (char* p, int e) noexcept -> char* {
+    *p++ = 'e';
+    *p++ = (e < 0) ? '-' : '+';
+    auto u = static_cast<unsigned>((e < 0) ? -e : e);
+    if (u >= 100u) {
+        *p++ = static_cast<char>('0' + u / 100u);
+        u %= 100u;
+    }
+    *p++ = static_cast<char>('0' + u / 10u);
+    *p++ = static_cast<char>('0' + u % 10u);
+    return p;
+}
+
+/**
+ * @brief Put the point or the exponent into the 'len' digits at 'buf',
+ *        the value is 0.digits * 10^n
+ */
+static auto format_digits (char* buf, int len, int decimal_exponent) noexcept
+-> char* {
+    constexpr auto min_n = -3;
+    constexpr auto max_n = 16;
+    
+    auto k = len;
+    auto n = len + decimal_exponent;
+    if ((k <= n) && (n <= max_n)) {
+        /// digits000.0
+        std::memset(buf + k, '0', static_cast<std::size_t>(n - k));
+        buf[n] = '.';
+        buf[n + 1] = '0';
+        return buf + n + 2;
+    }
+    if ((0 < n) && (n <= max_n)) {
+        /// dig.its
+        std::memmove(buf + n + 1, buf + n, static_cast<std::size_t>(k - n));
+        buf[n] = '.';
+        return buf + k + 1;
+    }
+    if ((min_n <= n) && (n <= 0)) {
+        /// 0.000digits
+        std::memmove(buf + 2 - n, buf, static_cast<std::size_t>(k));
+        buf[0] = '0';
+        buf[1] = '.';
+        std::memset(buf + 2, '0', static_cast<std::size_t>(-n));
+        return buf + 2 - n + k;
+    }
+    /// d.igitse+nn
+    if (k == 1) {
+        return append_exponent(buf + 1, n - 1);
+    }
+    std::memmove(buf + 2, buf + 1, static_cast<std::size_t>(k - 1));
+    buf[1] = '.';
+    return append_exponent(buf + k + 1, n - 1);
+}
+
+/**
+ * @brief Unsigned integer of a fixed capacity, enough for the value of any
+ *        double times 10 to the power of the length of its expansion:
+ *        2^53 * 5^1074 < 2^2548
+ */
+class big_uint {
+public:
+    constexpr static auto capacity = std::size_t(80u);
+
+private:
+    /**
+     * @brief little-endian words, [0, _n) are in use, the top one is not 0
+     */
+    std::uint32_t _w[capacity];
+    std::size_t _n;
+
+public:
+    explicit big_uint (std::uint64_t v) noexcept : _n(0u) {
+        _w[0u] = static_cast<std::uint32_t>(v);
+        _w[1u] = static_cast<std::uint32_t>(v >> 32u);
+        _n = (_w[1u] != 0u) ? 2u : (_w[0u] != 0u) ? 1u : 0u;
+    }
+
+public:
+    [[nodiscard]]
+    auto is_zero () const noexcept -> bool {
+        return _n == 0u;
+    }
+    
+    auto mul (std::uint32_t m) noexcept -> void {
+        auto carry = std::uint64_t(0u);
+        for (std::size_t i = 0u; i < _n; ++i) {
+            carry += std::uint64_t(_w[i]) * m;
+            _w[i] = static_cast<std::uint32_t>(carry);
+            carry >>= 32u;
+        }
+        if (carry != 0u) {
+            _w[_n++] = static_cast<std::uint32_t>(carry);
+        }
+    }
+    
+    auto mul_pow5 (std::size_t e) noexcept -> void {
+        /// 5^13 is the largest power of 5 in 32 bits
+        constexpr auto pow5_13 = std::uint32_t(1220703125u);
+        for (; e >= 13u; e -= 13u) {
+            mul(pow5_13);
+        }
+        auto m = std::uint32_t(1u);
+        for (; e != 0u; --e) {
+            m *= 5u;
+        }
+        mul(m);
+    }
+    
+    auto shl (std::size_t bits) noexcept -> void {
+        if (_n == 0u) {
+            return;
+        }
+        auto words = bits / 32u;
+        auto s = bits % 32u;
+        auto top = (s != 0u) ? (_w[_n - 1u] >> (32u - s)) : 0u;
+        for (auto i = _n; i-- > 0u;) {
+            auto lo = ((s != 0u) && (i != 0u)) ? (_w[i - 1u] >> (32u - s)) : 0u;
+            _w[i + words] = (_w[i] << s) | lo;
+        }
+        for (std::size_t i = 0u; i < words; ++i) {
+            _w[i] = 0u;
+        }
+        _n += words;
+        if (top != 0u) {
+            _w[_n++] = top;
+        }
+    }
+    
+    /**
+     * @brief Divide by 2^bits, rounded half to even
+     */
+    auto shr_round (std::size_t bits) noexcept -> void {
+        if ((bits == 0u) || (_n == 0u)) {
+            return;
+        }
+        auto half = _bit(bits - 1u);
+        auto sticky = false;
+        for (std::size_t i = 0u; (i < (bits - 1u) / 32u) && (i < _n); ++i) {
+            sticky = sticky || (_w[i] != 0u);
+        }
+        auto low = (bits - 1u) % 32u;
+        if (((bits - 1u) / 32u < _n) && (low != 0u)) {
+            sticky = sticky ||
+                     ((_w[(bits - 1u) / 32u] & ((1u << low) - 1u)) != 0u);
+        }
+        
+        auto words = bits / 32u;
+        auto s = bits % 32u;
+        if (words >= _n) {
+            _n = 0u;
+        } else {
+            for (std::size_t i = 0u; i + words < _n; ++i) {
+                auto hi = ((s != 0u) && (i + words + 1u < _n)) ?
+                          (_w[i + words + 1u] << (32u - s)) : 0u;
+                _w[i] = (_w[i + words] >> s) | hi;
+            }
+            _n -= words;
+            _trim();
+        }
+        
+        if (half && (sticky || _bit(0u))) {
+            _add_one();
+        }
+    }
+    
+    /**
+     * @return remainder
+     */
+    auto div (std::uint32_t d) noexcept -> std::uint32_t {
+        auto rem = std::uint64_t(0u);
+        for (auto i = _n; i-- > 0u;) {
+            rem = (rem << 32u) | _w[i];
+            _w[i] = static_cast<std::uint32_t>(rem / d);
+            rem %= d;
+        }
+        _trim();
+        return static_cast<std::uint32_t>(rem);
+    }
+
+private:
+    [[nodiscard]]
+    auto _bit (std::size_t i) const noexcept -> bool {
+        return (i / 32u < _n) && (((_w[i / 32u] >> (i % 32u)) & 1u) != 0u);
+    }
+    
+    auto _trim () noexcept -> void {
+        while ((_n != 0u) && (_w[_n - 1u] == 0u)) {
+            --_n;
+        }
+    }
+    
+    auto _add_one () noexcept -> void {
+        for (std::size_t i = 0u; i < _n; ++i) {
+            if (++_w[i] != 0u) {
+                return;
+            }
+        }
+        _w[_n++] = 1u;
+    }
+};
+
+/**
+ * @brief Digits of 'v' with the point before the last 'fraction' ones,
+ *        at least one digit before the point, given to 'write' in spans
+ */
+template <typename Write>
+static auto write_with_point (
+    const Write& write, big_uint& v, std::size_t fraction
+) noexcept {
+    /// base 10^9 parts, the least significant first: 2548 bits take at
+    /// most 86 of them
+    std::uint32_t parts[86u];
+    auto count = std::size_t(0u);
+    while (!v.is_zero()) {
+        parts[count++] = v.div(1000000000u);
+    }
+    
+    auto digits = std::size_t(0u);
+    if (count != 0u) {
+        digits = 9u * (count - 1u);
+        for (auto top = parts[count - 1u]; top != 0u; top /= 10u) {
+            ++digits;
+        }
+    }
+    
+    char buf[64u];
+    auto len = std::size_t(0u);
+    /// digits left before the point
+    auto integral = (digits > fraction) ? (digits - fraction) : 1u;
+    auto put = [&](char c) {
+        if (len + 2u > sizeof(buf)) {
+            write(buf, len);
+            len = 0u;
+        }
+        buf[len++] = c;
+        if ((--integral == 0u) && (fraction != 0u)) {
+            buf[len++] = '.';
+        }
+    };
+    
+    for (auto i = digits; i < fraction + 1u; ++i) {
+        put('0');
+    }
+    for (auto i = count; i-- > 0u;) {
+        char part[9u];
+        auto p = parts[i];
+        for (auto j = 9u; j-- > 0u;) {
+            part[j] = static_cast<char>('0' + p % 10u);
+            p /= 10u;
+        }
+        auto skip = (i + 1u == count) ? (9u * count - digits) : 0u;
+        for (auto j = skip; j < 9u; ++j) {
+            put(part[j]);
+        }
+    }
+    write(buf, len);
+}
+
+}
+
+/**
+ * @brief Enough for the longest shortest form: "-1.2345678901234567e-308"
+ */
+constexpr static auto shortest_size = std::size_t(32u);
+
+/**
+ * @brief Shortest characters that read back as 'value': "0.3", "-1.5e+300",
+ *        "100.0", "inf", "nan".
+ * @param out -- room for shortest_size characters
+ * @return past the last character
+ */
+template <typename F>
+static auto to_shortest (char* out, F value) noexcept -> char* {
+    static_assert(
+        std::is_same_v<F, float> || std::is_same_v<F, double>,
+        "only float and double are supported"
+    );
+    if (std::signbit(value)) {
+        *out++ = '-';
+        value = -value;
+    }
+    if (std::isnan(value)) {
+        std::memcpy(out, "nan", 3u);
+        return out + 3u;
+    }
+    if (std::isinf(value)) {
+        std::memcpy(out, "inf", 3u);
+        return out + 3u;
+    }
+    if (value == F(0)) {
+        std::memcpy(out, "0.0", 3u);
+        return out + 3u;
+    }
+    auto len = 0;
+    auto decimal_exponent = 0;
+    _implementation::grisu2(out, len, decimal_exponent, value);
+    return _implementation::format_digits(out, len, decimal_exponent);
+}
+
+/**
+ * @brief Exact value rounded half to even to 'precision' digits after the
+ *        point, same as printf "%.Nf" does: "3.142", "-0.000", "1e+300" as
+ *        all its 301 digits. No point when the precision is 0.
+ * @param write -- callable as write(const char*, std::size_t), takes the
+ *        characters in spans
+ * @param uppercase -- "INF" and "NAN", as "%F" prints them
+ */
+template <typename Write>
+static auto to_fixed (
+    const Write& write, double value, std::size_t precision, bool uppercase
+) noexcept {
+    if (std::signbit(value)) {
+        write("-", 1u);
+        value = -value;
+    }
+    if (std::isnan(value)) {
+        write(uppercase ? "NAN" : "nan", 3u);
+        return;
+    }
+    if (std::isinf(value)) {
+        write(uppercase ? "INF" : "inf", 3u);
+        return;
+    }
+    
+    auto v = _implementation::decompose(value);
+    auto r = _implementation::big_uint(v.f);
+    /// digits of the fraction that may be other than 0, value * 10^exact
+    /// is computed and rounded, the rest are zeros
+    auto exact = std::size_t(0u);
+    if (v.e >= 0) {
+        r.shl(static_cast<std::size_t>(v.e));
+    } else {
+        auto shift = static_cast<std::size_t>(-v.e);
+        exact = (precision < shift) ? precision : shift;
+        r.mul_pow5(exact);
+        r.shr_round(shift - exact);
+    }
+    _implementation::write_with_point(write, r, exact);
+    
+    if (precision == exact) {
+        return;
+    }
+    if (exact == 0u) {
+        write(".", 1u);
+    }
+    constexpr static char zeros[] = "0000000000000000000000000000000000000000";
+    for (auto n = precision - exact; n != 0u;) {
+        auto chunk = (n < sizeof(zeros) - 1u) ? n : (sizeof(zeros) - 1u);
+        write(zeros, chunk);
+        n -= chunk;
+    }
+}
+
+}
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_IOFMT_COMMON_DTOA_HPP
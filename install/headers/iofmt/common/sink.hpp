@@ -0,0 +1,199 @@
+/** @file sink.hpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Output of whole spans of characters instead of a single character
+ *         at a time.
+ *
+ * @details
+ *
+ *        The output functor of iofmt ('putc') may be either:
+ *        - a callable that takes a single char, as before
+ *        - a sink: an object with write(const char*, std::size_t) const,
+ *          a call of operator() is not required then
+ *        Strings, rendered numbers and literal runs of the format are given
+ *        to a sink in a single write() each, a plain callable still gets
+ *        them a character at a time.
+ *
+ *        'buffered' is a sink that collects the output in a fixed buffer and
+ *        passes it downstream in bulk when the buffer is full, on flush()
+ *        and on its destruction. So a UART/DMA transfer or a write(2) is
+ *        done once per buffer instead of once per character.
+ *        It is not synchronized.
+ *
+ * Usage example:
+ *
+ * struct fd_sink {
+ *     auto write (const char* s, std::size_t n) const noexcept {
+ *         ::write(1, s, n);
+ *     }
+ * };
+ * constexpr static auto fd = fd_sink();
+ * static auto out = sink::buffered<fd_sink, fd, 512>();
+ *
+ * using pf = printf::str_and_int::printf_t<decltype(out), out>;
+ * pf().printf("%d items\n", 42);
+ * out.flush();
+ */
+
+#ifndef KCPPT_IOFMT_COMMON_SINK_HPP
+#define KCPPT_IOFMT_COMMON_SINK_HPP
+
+#include <cinttypes>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace kcppt {
+
+namespace iofmt {
+
+namespace common {
+
+namespace sink {
+
+template <typename Out, typename = void>
+struct is_sink : std::false_type {};
+
+template <typename Out>
+struct is_sink<Out, std::void_t<decltype(
+    std::declval<const Out&>().write(
+        std::declval<const char*>(), std::declval<std::size_t>()
+    )
+)>> : std::true_type {};
+
+template <typename Out>
+constexpr static auto is_sink_v = is_sink<Out>::value;
+
+/**
+ * @brief Output 'n' characters of 's', in a single call if 'out' is a sink
+ */
+template <typename Out>
+static auto write (const Out& out, const char* s, std::size_t n) noexcept {
+    if constexpr (is_sink_v<Out>) {
+        out.write(s, n);
+    } else {
+        for (std::size_t i = 0u; i < n; ++i) {
+            out(s[i]);
+        }
+    }
+}
+
+/**
+ * @brief Output a single character
+ */
+template <typename Out>
+static auto put (const Out& out, char c) noexcept {
+    if constexpr (is_sink_v<Out>) {
+        out.write(&c, 1u);
+    } else {
+        out(c);
+    }
+}
+
+/**
+ * @tparam Out -- type of the downstream output, a sink or a putc callable
+ * @tparam out -- downstream output with static storage duration
+ * @tparam Capacity -- size of the buffer in characters
+ */
+template <typename Out, const Out& out, std::size_t Capacity = 256u>
+class buffered {
+    static_assert(Capacity != 0u);
+
+private:
+    /**
+     * @brief iofmt calls its output through a const reference
+     */
+    mutable char _buffer[Capacity];
+    mutable std::size_t _size;
+
+public:
+    constexpr buffered () noexcept :
+        _buffer(),
+        _size(0u)
+    {}
+    
+    buffered (const buffered&) = delete;
+    auto operator= (const buffered&) -> buffered& = delete;
+    
+    ~buffered () noexcept {
+        flush();
+    }
+
+public:
+    auto operator() (char c) const noexcept {
+        if (_size == Capacity) {
+            flush();
+        }
+        _buffer[_size++] = c;
+    }
+    
+    /**
+     * @brief Spans that don't fit the buffer at all bypass it
+     */
+    auto write (const char* s, std::size_t n) const noexcept {
+        if (n > Capacity - _size) {
+            flush();
+            if (n >= Capacity) {
+                sink::write(out, s, n);
+                return;
+            }
+        }
+        std::memcpy(_buffer + _size, s, n);
+        _size += n;
+    }
+    
+    /**
+     * @brief Pass everything buffered downstream
+     */
+    auto flush () const noexcept {
+        if (_size != 0u) {
+            sink::write(out, _buffer, _size);
+            _size = 0u;
+        }
+    }
+    
+    [[nodiscard]]
+    auto size () const noexcept -> std::size_t {
+        return _size;
+    }
+    
+    [[nodiscard]]
+    constexpr static auto capacity () noexcept -> std::size_t {
+        return Capacity;
+    }
+};
+
+}
+
+}
+
+}
+
+}
+
+#endif /// KCPPT_IOFMT_COMMON_SINK_HPP
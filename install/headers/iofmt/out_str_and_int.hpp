@@ -111,6 +111,37 @@ struct [[nodiscard]] sdec {
     constexpr explicit sdec (V v) noexcept : _v(integral_cast(v)) {}
 };
 
+/**
+ * @brief Exact value with 'precision' digits after the point, "%.Nf"
+ */
+template <typename V>
+struct [[nodiscard]] fixed {
+    V _v;
+    std::size_t _p;
+    constexpr fixed (V v, std::size_t precision) noexcept :
+        _v(v), _p(precision)
+    {}
+};
+
+/**
+ * @brief Bytes of a buffer, two hex digits per byte in memory order
+ */
+struct [[nodiscard]] hexdump {
+    const void* _p;
+    std::size_t _n;
+    constexpr hexdump (const void* p, std::size_t n) noexcept :
+        _p(p), _n(n)
+    {}
+};
+
+struct [[nodiscard]] HEXDUMP {
+    const void* _p;
+    std::size_t _n;
+    constexpr HEXDUMP (const void* p, std::size_t n) noexcept :
+        _p(p), _n(n)
+    {}
+};
+
 enum class jst : bool { left, right };
 
 template <typename V>
@@ -147,7 +178,7 @@ public:
     }
     
     static auto println () noexcept {
-        _printf.printf(_endl[_idx]);
+        _wra::string(_endl[_idx]);
     }
     
     template <typename V, util::enable_if_char_t<V>* = nullptr>
@@ -157,30 +188,44 @@ public:
 
     template <typename V, util::enable_if_signed_t<V>* = nullptr>
     static auto print (V v) noexcept {
-        _printf.printf(fmtints_by_type::sdec_v<V>, v);
+        _wri::decimal_signed_with_negative(v);
     }
 
     template <typename V, util::enable_if_unsigned_t<V>* = nullptr>
     static auto print (V v) noexcept {
-        _printf.printf(fmtints_by_type::udec_v<V>, v);
+        _wri::decimal_unsigned(v);
     }
 
     template <typename V, util::enable_if_bool_t<V>* = nullptr>
     static auto print (V v) noexcept {
-        _printf.printf(v ? "true" : "false");
+        _wra::string(v ? "true" : "false");
+    }
+
+    /**
+     * @brief The shortest form that reads back as the same value
+     */
+    template <typename V, util::enable_if_floating_point_t<V>* = nullptr>
+    static auto print (V v) noexcept {
+        static_assert(
+            !std::is_same_v<V, long double>, "long double is not supported"
+        );
+        _wrf::shortest(v);
     }
 
     template <typename V>
     static auto print (V* v) noexcept {
-        _printf.printf(fmtptr::HEX_v, v);
+        _wri::hexadecimal_uppercase(reinterpret_cast<std::uintptr_t>(v));
     }
 
+    /**
+     * @brief Strings are printed as they are, '%' is not a format here
+     */
     static auto print (char* str) noexcept {
-        _printf.printf(str);
+        _wra::string(str);
     }
 
     static auto print (const char* str) noexcept {
-        _printf.printf(str);
+        _wra::string(str);
     }
 
     template <typename PT0, typename PT1, typename ... PTs>
@@ -199,32 +244,48 @@ public:
 public:
     template <typename V>
     static auto print (const fmt::hex<V>& obj) noexcept {
-        auto mul = _print_negative_sign_if_any(obj);
-        _printf.printf(fmtints_by_type::hex_v<decltype(obj._v)>, mul * obj._v);
+        (void)_print_negative_sign_if_any(obj);
+        _print_magnitude(obj);
     }
 
     template <typename V>
     static auto print (const fmt::HEX<V>& obj) noexcept {
-        auto mul = _print_negative_sign_if_any(obj);
-        _printf.printf(fmtints_by_type::HEX_v<decltype(obj._v)>, mul * obj._v);
+        (void)_print_negative_sign_if_any(obj);
+        _print_magnitude(obj);
     }
 
     template <typename V>
     static auto print (const fmt::oct<V>& obj) noexcept {
-        auto mul = _print_negative_sign_if_any(obj);
-        _printf.printf(fmtints_by_type::oct_v<decltype(obj._v)>, mul * obj._v);
+        (void)_print_negative_sign_if_any(obj);
+        _print_magnitude(obj);
     }
 
     template <typename V>
     static auto print (const fmt::udec<V>& obj) noexcept {
-        auto mul = _print_negative_sign_if_any(obj);
-        _printf.printf(fmtints_by_type::udec_v<decltype(obj._v)>, mul * obj._v);
+        (void)_print_negative_sign_if_any(obj);
+        _print_magnitude(obj);
     }
 
     template <typename V>
     static auto print (const fmt::sdec<V>& obj) noexcept {
-        auto mul = _print_negative_sign_if_any(obj);
-        _printf.printf(fmtints_by_type::sdec_v<decltype(obj._v)>, mul * obj._v);
+        (void)_print_negative_sign_if_any(obj);
+        _print_magnitude(obj);
+    }
+
+    template <typename V>
+    static auto print (const fmt::fixed<V>& obj) noexcept {
+        static_assert(
+            !std::is_same_v<V, long double>, "long double is not supported"
+        );
+        _wrf::fixed_lowercase(obj._v, obj._p);
+    }
+
+    static auto print (const fmt::hexdump& obj) noexcept {
+        _print_magnitude(obj);
+    }
+
+    static auto print (const fmt::HEXDUMP& obj) noexcept {
+        _print_magnitude(obj);
     }
 
 public:
@@ -235,14 +296,21 @@ public:
             print(pad._v);
             _print_padding(l, pad._w, ' ');
         } else {
-            auto mul = _print_negative_sign_if_any(pad._v);
+            (void)_print_negative_sign_if_any(pad._v);
             _print_padding(l, pad._w, pad._p);
-            _print_with_mul(mul, pad._v);
+            _print_magnitude(pad._v);
         }
     }
 
 private:
     constexpr static auto _printf = Printf();
+    /**
+     * @brief the typed overloads render straight into the output, without
+     *        a format string and va_list
+     */
+    using _wra = typename Printf::out_ascii_t;
+    using _wri = typename Printf::out_integrals_t;
+    using _wrf = typename Printf::out_floats_t;
     constexpr static auto fmt_size_t = fmtints_by_type::udec_v<std::size_t>;
     
     struct idx {
@@ -309,17 +377,10 @@ private:
     constexpr static auto _value_print_length (
         V v, std::size_t div
     ) noexcept -> std::size_t {
-        if (v == 0) {
-            return 1u;
-        }
-        auto cnt = std::size_t{0u};
-        if constexpr (std::is_signed_v<V>) {
-            if (v < 0) {
-                v *= -1;
-            }
-        }
-        while (v) {
-            v /= div;
+        auto u = _magnitude(v);
+        auto cnt = std::size_t{1u};
+        while (u >= div) {
+            u /= div;
             ++cnt;
         }
         return cnt;
@@ -361,6 +422,16 @@ private:
         return _value_print_length(v._v, 10u);
     }
 
+    [[nodiscard]]
+    constexpr static auto _value_print_length (const fmt::hexdump& v) noexcept {
+        return v._n * 2u;
+    }
+
+    [[nodiscard]]
+    constexpr static auto _value_print_length (const fmt::HEXDUMP& v) noexcept {
+        return v._n * 2u;
+    }
+
     template <typename V, util::enable_if_class_t<V>* = nullptr>
     static auto _print_negative_sign_if_any (const V& v) noexcept -> int {
         if constexpr (!traits::is_signed_v<decltype(v._v)>) {
@@ -373,6 +444,19 @@ private:
         return -1;
     }
     
+    /**
+     * @brief the bytes of a dump have no sign
+     */
+    static auto _print_negative_sign_if_any (const fmt::hexdump&) noexcept
+    -> int {
+        return 1;
+    }
+    
+    static auto _print_negative_sign_if_any (const fmt::HEXDUMP&) noexcept
+    -> int {
+        return 1;
+    }
+    
     template <typename V, util::enable_if_integral_or_pointer_t<V>* = nullptr>
     static auto _print_negative_sign_if_any (V v) noexcept -> int {
         if constexpr (!traits::is_signed_v<V>) {
@@ -385,14 +469,59 @@ private:
         return -1;
     }
     
-    template <typename V, util::enable_if_class_t<V>* = nullptr>
-    static auto _print_with_mul (int mul, const V& v) noexcept {
-        print(mul * v._v);
+    /**
+     * @brief Absolute value, negated as unsigned so that the minimal value
+     *        of a signed type doesn't overflow
+     */
+    template <typename V>
+    [[nodiscard]]
+    constexpr static auto _magnitude (V v) noexcept -> unsigned long long {
+        using u_t = std::make_unsigned_t<V>;
+        auto u = static_cast<u_t>(v);
+        if constexpr (std::is_signed_v<V>) {
+            if (v < 0) {
+                u = static_cast<u_t>(u_t(0u) - u);
+            }
+        }
+        return u;
     }
     
     template <typename V, util::enable_if_integral_or_pointer_t<V>* = nullptr>
-    static auto _print_with_mul (int mul, V v) noexcept {
-        print(mul * v);
+    static auto _print_magnitude (V v) noexcept {
+        _wri::decimal_unsigned(_magnitude(v));
+    }
+    
+    template <typename V>
+    static auto _print_magnitude (const fmt::hex<V>& v) noexcept {
+        _wri::hexadecimal_lowercase(_magnitude(v._v));
+    }
+    
+    template <typename V>
+    static auto _print_magnitude (const fmt::HEX<V>& v) noexcept {
+        _wri::hexadecimal_uppercase(_magnitude(v._v));
+    }
+    
+    template <typename V>
+    static auto _print_magnitude (const fmt::oct<V>& v) noexcept {
+        _wri::octal(_magnitude(v._v));
+    }
+    
+    static auto _print_magnitude (const fmt::hexdump& v) noexcept {
+        _wri::hexdump_lowercase(v._p, v._n);
+    }
+    
+    static auto _print_magnitude (const fmt::HEXDUMP& v) noexcept {
+        _wri::hexdump_uppercase(v._p, v._n);
+    }
+    
+    template <typename V>
+    static auto _print_magnitude (const fmt::udec<V>& v) noexcept {
+        _wri::decimal_unsigned(_magnitude(v._v));
+    }
+    
+    template <typename V>
+    static auto _print_magnitude (const fmt::sdec<V>& v) noexcept {
+        _wri::decimal_unsigned(_magnitude(v._v));
     }
     
 };
@@ -35,9 +35,14 @@
 
 #include "../common/conversion_table.hpp"
 #include "../common/conversion.hpp"
+#include "../common/sink.hpp"
 #include "../../util.hpp"
 
+#include <array>
 #include <cstdarg>
+#include <cstddef>
+#include <tuple>
+#include <utility>
 
 namespace kcppt {
 
@@ -59,12 +64,21 @@ template <
     std::size_t maxfmtlen = 256u
 >
 class printf_t {
+public:
+    /**
+     * @brief Renderers bound to the same output, for the typed callers that
+     *        don't need the format parsing at all
+     */
+    using out_ascii_t = common::builtin::out::ascii<PutcLambda, putc>;
+    using out_integrals_t = common::builtin::out::integrals<PutcLambda, putc>;
+    using out_floats_t = common::builtin::out::floats<PutcLambda, putc>;
+
 public:
     constexpr printf_t () noexcept = default;
     
 public:
     auto putchar (char c) const noexcept {
-        putc(c);
+        common::sink::put(putc, c);
     }
     
     auto printf (const char* fmt, ...) const noexcept {
@@ -74,6 +88,32 @@ public:
         va_end(arglist);
     }
     
+    /**
+     * @brief Same as printf, but the format is parsed at compile time into
+     *        literal spans and conversions bound to the arguments. The count
+     *        and the types of the arguments are checked against the
+     *        conversions, at run time only the characters are emitted.
+     *        Unknown conversions are printed as they are, same as in printf.
+     *
+     *        Usage:
+     *        constexpr static char fmt[] = "%d items, %s\n";
+     *        printf_t<...>().printf<fmt>(42, "ok");
+     *
+     * @tparam Fmt -- constexpr char array with static storage duration
+     */
+    template <const auto& Fmt, typename...Args>
+    auto printf (const Args&...args) const noexcept {
+        using compiled = _compiled<Fmt>;
+        static_assert(
+            sizeof...(Args) == compiled::arguments_count,
+            "number of the arguments doesn't match the format"
+        );
+        _print_compiled<Fmt>(
+            std::make_index_sequence<compiled::tokens_count>(),
+            std::forward_as_tuple(args...)
+        );
+    }
+    
     auto vprintf (const char* fmt, std::va_list& arglist) const noexcept {
         auto p = fmt; // proxy pointer
         for (std::size_t i = 0u; i < maxfmtlen; ++i) {
@@ -88,12 +128,13 @@ public:
 
 private:
     constexpr static auto _cvspecs =
-        util::slice<cvsp::idx::c, cvsp::idx::u + 1u>(cvsp::values);
+        util::slice<cvsp::idx::c, cvsp::idx::F + 1u>(cvsp::values);
     constexpr static auto _lenmods =
         util::slice<lmod::idx::_hh, lmod::idx::_ll + 1u>(lmod::values);
     
     using wra = cv::out::ascii<PutcLambda, putc>;
     using wri = cv::out::integrals<PutcLambda, putc>;
+    using wrf = cv::out::floats<PutcLambda, putc>;
     // write-out function pointer type
     using fpwrout_t = void(*)(const void*);
     
@@ -104,6 +145,20 @@ private:
     constexpr static auto _row_size = _cvspecs.size();
     constexpr static auto _col_size = _lenmods.size();
     
+    /**
+     * @brief "%f" without the precision prints 6 digits after the point
+     */
+    constexpr static auto _default_precision = std::size_t(6u);
+    /**
+     * @brief larger precisions are not parsed further
+     */
+    constexpr static auto _precision_limit = std::size_t(1000000u);
+    
+    /// 'p' and 'n' are not parsed, their rows are never taken
+    static auto _n_a (const void* pmem) noexcept {
+        (void)pmem;
+    }
+    
     constexpr static fpwrout_t _out_table[_row_size][_col_size] {
 /**            hh,              h,        none,           l,          ll */
 /**c*/  {wra::_hhc, wra::__hc, wra::___c, wra::__lc, wra::_llc},
@@ -113,6 +168,10 @@ private:
 /**x*/  {wri::_hhx, wri::__hx, wri::___x, wri::__lx, wri::_llx},
 /**X*/  {wri::_hhX, wri::__hX, wri::___X, wri::__lX, wri::_llX},
 /**u*/  {wri::_hhu, wri::__hu, wri::___u, wri::__lu, wri::_llu},
+/**p*/  {_n_a,      _n_a,      _n_a,      _n_a,      _n_a     },
+/**n*/  {_n_a,      _n_a,      _n_a,      _n_a,      _n_a     },
+/**f*/  {wrf::_hhf, wrf::__hf, wrf::___f, wrf::__lf, wrf::_llf},
+/**F*/  {wrf::_hhF, wrf::__hF, wrf::___F, wrf::__lF, wrf::_llF},
     };
     
 //    /// table of expected sizes to read from argument list when encountered specific token
@@ -129,7 +188,7 @@ private:
 
 private:
     [[nodiscard]]
-    static auto parse_length_mod (const char* next, std::size_t& offs) noexcept
+    constexpr static auto parse_length_mod (const char* next, std::size_t& offs) noexcept
     -> std::size_t {
         auto c0 = next[0u];
         auto c1 = next[1u];
@@ -151,7 +210,7 @@ private:
     }
     
     [[nodiscard]]
-    static auto parse_conv_spec (const char* next, std::size_t& offs) noexcept
+    constexpr static auto parse_conv_spec (const char* next, std::size_t& offs) noexcept
     -> std::size_t {
         auto c0 = next[0u];
         
@@ -170,10 +229,12 @@ private:
             return _row_index::X;
         } else if (c0 == 'u') {
             return _row_index::u;
+        } else if (c0 == 'f') {
+            return _row_index::f;
+        } else if (c0 == 'F') {
+            return _row_index::F;
         }
-//        else if ((c == 'f') || (c == 'F')) { /// floats are not supported (decimal notation)
-//            return conv_spec::none;
-//        } else if ((c == 'e') || (c == 'E')) { /// floats are not supported (scientific decimal notation)
+//        else if ((c == 'e') || (c == 'E')) { /// floats are not supported (scientific decimal notation)
 //            return conv_spec::none;
 //        } else if ((c == 'a') || (c == 'A')) { /// floats are not supported (hexadecimal notation)
 //            return conv_spec::none;
@@ -188,17 +249,246 @@ private:
         return _row_size;
     }
     
+    /**
+     * @brief ".N", only the floats take it
+     * @return false if there is no precision
+     */
+    constexpr static auto parse_precision (
+        const char* next, std::size_t& offs, std::size_t& prec_out
+    ) noexcept -> bool {
+        prec_out = _default_precision;
+        if (next[0u] != '.') {
+            return false;
+        }
+        ++offs;
+        prec_out = 0u;
+        for (auto i = 1u; (next[i] >= '0') && (next[i] <= '9'); ++i) {
+            if (prec_out < _precision_limit) {
+                prec_out = prec_out * 10u + static_cast<std::size_t>(
+                    next[i] - '0'
+                );
+            }
+            ++offs;
+        }
+        return true;
+    }
+    
     // parse the symbol next after the first '%' (see the use in printf_light below)
     [[nodiscard]]
-    static auto parse_argtok (
-        const char* next, std::size_t& col_out, std::size_t& row_out
+    constexpr static auto parse_argtok (
+        const char* next, std::size_t& col_out, std::size_t& row_out,
+        std::size_t& prec_out
     ) noexcept -> std::size_t {
         auto offs = std::size_t(0u);
-        col_out  = parse_length_mod(next, offs);
+        auto has_precision = parse_precision(next, offs, prec_out);
+        if (next[offs] == '\0') {
+            row_out = _row_size;
+            return offs;
+        }
+        col_out  = parse_length_mod(&next[offs], offs);
         row_out = parse_conv_spec(&next[offs], offs);
+        if (has_precision && (row_out != _row_size) &&
+            (row_out != _row_index::f) && (row_out != _row_index::F)) {
+            row_out = _row_size;
+        }
         return offs;
     }
 
+private:
+    /**
+     * @brief Compile-time format: literal spans and conversions
+     */
+    struct _token {
+        std::size_t begin;
+        std::size_t size;
+        /**
+         * @brief _row_size for the literal spans
+         */
+        std::size_t row;
+        std::size_t col;
+        /**
+         * @brief index of the argument of the conversion
+         */
+        std::size_t arg;
+        std::size_t prec;
+    };
+    
+    /**
+     * @brief Split the format the same way as process_char_pointer does
+     * @param out -- nullptr to only count the tokens
+     * @return number of the tokens
+     */
+    constexpr static auto _tokenize (const char* p, _token* out) noexcept
+    -> std::size_t {
+        auto n = std::size_t(0u);
+        auto args = std::size_t(0u);
+        /// end of the last token if it is a literal, neighbouring literals
+        /// are merged into a single span
+        auto literal_end = std::size_t(0u);
+        auto literal = [&n, &literal_end, out](
+            std::size_t begin, std::size_t size
+        ) {
+            if ((n != 0u) && (literal_end == begin)) {
+                if (out != nullptr) {
+                    out[n - 1u].size += size;
+                }
+            } else {
+                if (out != nullptr) {
+                    out[n] = _token{begin, size, _row_size, 0u, 0u, 0u};
+                }
+                ++n;
+            }
+            literal_end = begin + size;
+        };
+        
+        auto i = std::size_t(0u);
+        while (p[i] != '\0') {
+            if (p[i] != '%') {
+                auto j = i + 1u;
+                while ((p[j] != '\0') && (p[j] != '%')) {
+                    ++j;
+                }
+                literal(i, j - i);
+                i = j;
+                continue;
+            }
+            if (p[i + 1u] == '\0') {
+                break;
+            }
+            auto col = _col_size;
+            auto row = _row_size;
+            auto prec = _default_precision;
+            auto offs = parse_argtok(&p[i + 1u], col, row, prec);
+            if (row == _row_size) {
+                literal(i, offs + 1u);
+            } else {
+                if (out != nullptr) {
+                    out[n] = _token{i, offs + 1u, row, col, args, prec};
+                }
+                ++n;
+                ++args;
+                literal_end = 0u;
+            }
+            i += offs + 1u;
+        }
+        return n;
+    }
+    
+    template <const auto& Fmt>
+    struct _compiled {
+        constexpr static auto tokens_count = _tokenize(Fmt, nullptr);
+        
+        constexpr static auto tokens = [] {
+            std::array<_token, tokens_count> ret {};
+            (void)_tokenize(Fmt, ret.data());
+            return ret;
+        }();
+        
+        constexpr static auto arguments_count = [] {
+            auto ret = std::size_t(0u);
+            for (std::size_t i = 0u; i < tokens_count; ++i) {
+                ret += (tokens[i].row != _row_size) ? 1u : 0u;
+            }
+            return ret;
+        }();
+    };
+    
+    /**
+     * @brief Types read by the _out_table functions
+     */
+    using _value_types = std::tuple<
+/**                       hh,              h,           none,              l,             ll */
+/**c*/  std::tuple<cv::type::_hhc, cv::type::__hc, cv::type::___c, cv::type::__lc, cv::type::_llc>,
+/**s*/  std::tuple<cv::type::_hhs, cv::type::__hs, cv::type::___s, cv::type::__ls, cv::type::_lls>,
+/**d*/  std::tuple<cv::type::_hhd, cv::type::__hd, cv::type::___d, cv::type::__ld, cv::type::_lld>,
+/**o*/  std::tuple<cv::type::_hho, cv::type::__ho, cv::type::___o, cv::type::__lo, cv::type::_llo>,
+/**x*/  std::tuple<cv::type::_hhx, cv::type::__hx, cv::type::___x, cv::type::__lx, cv::type::_llx>,
+/**X*/  std::tuple<cv::type::_hhX, cv::type::__hX, cv::type::___X, cv::type::__lX, cv::type::_llX>,
+/**u*/  std::tuple<cv::type::_hhu, cv::type::__hu, cv::type::___u, cv::type::__lu, cv::type::_llu>,
+/**p*/  std::tuple<void,           void,           void,           void,           void>,
+/**n*/  std::tuple<void,           void,           void,           void,           void>,
+/**f*/  std::tuple<cv::type::_hhf, cv::type::__hf, cv::type::___f, cv::type::__lf, cv::type::_llf>,
+/**F*/  std::tuple<cv::type::_hhF, cv::type::__hF, cv::type::___F, cv::type::__lF, cv::type::_llF>
+    >;
+    
+    template <std::size_t row, std::size_t col>
+    using _value_type_t = std::tuple_element_t<
+        col, std::tuple_element_t<row, _value_types>
+    >;
+    
+    /**
+     * @brief Same conversions as process_va_list takes
+     */
+    template <std::size_t row, std::size_t col>
+    constexpr static auto _is_supported =
+        (row == _row_index::f) || (row == _row_index::F) ?
+            ((col == _col_index::___) || (col == _col_index::__l)) :
+        (row == _row_index::p) || (row == _row_index::n) ? false :
+        ((row != _row_index::c) && (row != _row_index::s)) ||
+        (col == _col_index::___);
+    
+    /**
+     * @brief Strings take anything convertible to const char*, floats take
+     *        float and double, the rest take integers of the same size as
+     *        printf reads after the default argument promotions
+     */
+    template <std::size_t row, std::size_t col, typename A>
+    [[nodiscard]]
+    constexpr static auto _argument_fits () noexcept -> bool {
+        using a_t = std::decay_t<A>;
+        if constexpr (row == _row_index::s) {
+            return std::is_convertible_v<a_t, const char*>;
+        } else if constexpr ((row == _row_index::f) || (row == _row_index::F)) {
+            return std::is_same_v<a_t, float> || std::is_same_v<a_t, double>;
+        } else if constexpr (std::is_integral_v<a_t>) {
+            using value_t = _value_type_t<row, col>;
+            return sizeof(decltype(+std::declval<a_t>())) ==
+                   sizeof(decltype(+std::declval<value_t>()));
+        } else {
+            return false;
+        }
+    }
+    
+    template <std::size_t row, std::size_t col, std::size_t prec, typename A>
+    static auto _print_argument (const A& a) noexcept {
+        static_assert(
+            _is_supported<row, col>, "the conversion is not supported"
+        );
+        static_assert(
+            _argument_fits<row, col, A>(),
+            "the argument doesn't match the conversion"
+        );
+        constexpr auto fout = _out_table[row][col];
+        if constexpr (row == _row_index::s) {
+            const char* v = a;
+            fout(&v);
+        } else if constexpr ((row == _row_index::f) || (row == _row_index::F)) {
+            auto v = _value_type_t<row, col>{static_cast<double>(a), prec};
+            fout(&v);
+        } else {
+            auto v = static_cast<_value_type_t<row, col>>(a);
+            fout(&v);
+        }
+    }
+    
+    template <const auto& Fmt, std::size_t I, typename Tuple>
+    static auto _print_token (const Tuple& args) noexcept {
+        constexpr auto t = _compiled<Fmt>::tokens[I];
+        if constexpr (t.row == _row_size) {
+            common::sink::write(putc, &Fmt[t.begin], t.size);
+        } else {
+            _print_argument<t.row, t.col, t.prec>(std::get<t.arg>(args));
+        }
+    }
+    
+    template <const auto& Fmt, std::size_t...Is, typename Tuple>
+    static auto _print_compiled (
+        std::index_sequence<Is...>, const Tuple& args
+    ) noexcept {
+        (void)args;
+        (_print_token<Fmt, Is>(args), ...);
+    }
+
 private:
     template <typename T>
     [[nodiscard]]
@@ -220,7 +510,8 @@ private:
     // I could possibly create some virtual wrappers around the natives,
     // maybe
     static auto process_va_list (
-        void* pbigmemz, std::va_list& arglist, std::size_t row, std::size_t col
+        void* pbigmemz, std::va_list& arglist, std::size_t row, std::size_t col,
+        std::size_t prec
     ) noexcept -> std::size_t {
         using ir = _row_index;
         using ic = _col_index;
@@ -251,6 +542,14 @@ private:
             } else if (col == ic::_ll) {
                 return process_va_list_helper<unsigned long long>(pbigmemz, arglist);
             }
+        } else if ((row == ir::f) || (row == ir::F)) {
+            // float is promoted to double, 'l' changes nothing
+            if ((col == ic::___) || (col == ic::__l)) {
+                using type = cv::type::___f;
+                *reinterpret_cast<type*>(pbigmemz) =
+                    type{va_arg(arglist, double), prec};
+                return sizeof(type);
+            }
         }
 
         return 0u;
@@ -276,28 +575,36 @@ private:
             
             auto col = _col_size;
             auto row = _row_size;
+            auto prec = _default_precision;
             auto j    = std::size_t(i + 1u); // save i + 1u
             
-            i += parse_argtok(&p[i + 1u], col, row);
+            i += parse_argtok(&p[i + 1u], col, row, prec);
             
             // if no valid conversion specifier was found
             // print out th
             if (row == _row_size) {
-                putc(c0);
-                for (; j < i + 1u; ++j) {
-                    putc(p[j]);
-                }
+                common::sink::write(putc, &p[j - 1u], i + 2u - j);
                 return op::cnt; ///< continue
             }
             
             using biggest_native_type = long double;
-            std::uint8_t magic_memory[sizeof(biggest_native_type)] {0};
+            /// a double with its precision may be larger than long double
+            constexpr auto magic_size =
+                (sizeof(biggest_native_type) > sizeof(cv::type::___f)) ?
+                sizeof(biggest_native_type) : sizeof(cv::type::___f);
+            alignas(std::max_align_t) std::uint8_t magic_memory[magic_size] {0};
             auto p_magic_memory = reinterpret_cast<void*>(&magic_memory);
             ///auto typesz =
-            process_va_list(p_magic_memory, arglist, row, col);
+            process_va_list(p_magic_memory, arglist, row, col, prec);
             _out_table[row][col](p_magic_memory);
         } else {
-            putc(c0);
+            /// the whole run of literal characters goes out as one span
+            auto j = i + 1u;
+            while ((j < maxfmtlen) && (p[j] != '\0') && (p[j] != '%')) {
+                ++j;
+            }
+            common::sink::write(putc, &p[i], j - i);
+            i = j - 1u;
         }
         return op::nop;
     }
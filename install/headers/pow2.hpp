@@ -69,7 +69,8 @@ constexpr auto greater_equal (T&& t) noexcept -> T {
     if (is_pow2(std::forward<T>(t))) {
         return t;
     }
-    return t << (bitwise::rshift_count<T, 1, 0>(std::forward<T>(t)) + 1u);
+    return std::decay_t<T>(1u) <<
+           (bitwise::rshift_count<T, 1, 0>(std::forward<T>(t)) + 1u);
 }
 
 /**
@@ -84,7 +85,8 @@ constexpr auto less_equal (T&& t) noexcept -> T {
     if (is_pow2(std::forward<T>(t))) {
         return t;
     }
-    return t << bitwise::rshift_count<T, 1, 0>(std::forward<T>(t));
+    return std::decay_t<T>(1u) <<
+           bitwise::rshift_count<T, 1, 0>(std::forward<T>(t));
 }
 
 }
@@ -99,7 +99,7 @@ template <typename T>
 class [[nodiscard]] range {
     static_assert(std::is_integral_v<T>);
 private:
-    using iterator = iterator<T, range>;
+    using iterator = kcppt::range::iterator<T, range>;
     
 private:
     T _ibegin;
@@ -151,7 +151,7 @@ public:
  */
 class [[nodiscard]] indices {
 private:
-    using iterator = iterator<std::size_t, indices>;
+    using iterator = kcppt::range::iterator<std::size_t, indices>;
     
     template <typename T, std::size_t Sz>
     using pod_array = T[Sz];
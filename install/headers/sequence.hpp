@@ -61,6 +61,25 @@ constexpr auto is_sorted (T0&& t0, T1&& t1, Ts&&...ts) noexcept -> bool {
     return is_sorted(t0, t1) && is_sorted(t1, ts...);
 }
 
+template <typename T0>
+[[nodiscard]]
+constexpr auto is_strictly_sorted (T0&&) noexcept -> bool {
+    return true;
+}
+
+template <typename T0, typename T1>
+[[nodiscard]]
+constexpr auto is_strictly_sorted (T0&& t0, T1&& t1) noexcept -> bool {
+    return t0 < t1;
+}
+
+template <typename T0, typename T1, typename...Ts>
+[[nodiscard]]
+constexpr auto is_strictly_sorted (T0&& t0, T1&& t1, Ts&&...ts) noexcept
+-> bool {
+    return is_strictly_sorted(t0, t1) && is_strictly_sorted(t1, ts...);
+}
+
 template <typename T>
 [[nodiscard]]
 constexpr auto accumulate (T&& t) noexcept -> T {
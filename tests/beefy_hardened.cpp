@@ -0,0 +1,110 @@
+/** @file beefy_hardened.cpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Batch deallocation of beefy allocators in hardened mode.
+ *
+ *         deallocate_n gets blocks of several storages in one batch, the
+ *         storage of the size must get only its own blocks (a hardened
+ *         storage traps on any other), the rest are found by the address.
+ *         Afterwards every storage must be completely free again.
+ *
+ *         Built with KCPPT_BEEFY_HARDENED, failures abort.
+ */
+
+#include "allocators/beefy.hpp"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+using namespace kcppt;
+using namespace kcppt::allocators;
+
+constexpr auto blocks_count = std::size_t(100u);
+
+auto check (bool ok, const char* what) -> void {
+    if (!ok) {
+        std::fprintf(stderr, "beefy hardened: %s\n", what);
+        std::abort();
+    }
+}
+
+beefy::storage<char, 8, blocks_count> s8;
+beefy::bitmap_storage<char, 16, blocks_count> s16;
+beefy::storage<char, 32, blocks_count> s32;
+
+auto ptrs = beefy::make_ptrs_to_storages_array<char>(s8, s16, s32);
+
+using virtual_allocator = beefy::allocator<char, decltype(ptrs), ptrs>;
+using direct_allocator = beefy::direct_allocator<char, s8, s16, s32>;
+
+/**
+ * @brief Every block of every storage is handed out, the batch of the
+ *        8-byte size interleaves the blocks of all three storages and is
+ *        longer than the on-stack buffer deallocate_n gathers them in
+ */
+template <typename A>
+auto mixed_batch () -> void {
+    auto a = A();
+    std::array<char*, 3u * blocks_count> batch {};
+    auto n = std::size_t(0u);
+    for (auto nT : { std::size_t(8u), std::size_t(16u), std::size_t(32u) }) {
+        std::array<char*, blocks_count> out {};
+        check(a.allocate_n(nT, out.size(), out.data()) == out.size(),
+              "a storage is not completely free");
+        for (auto k : range::range(out.size())) {
+            batch[3u * k + n] = out[k];
+        }
+        ++n;
+    }
+    a.deallocate_n(batch.data(), batch.size(), 8u);
+}
+
+template <typename A>
+auto check_free () -> void {
+    auto a = A();
+    for (auto nT : { std::size_t(8u), std::size_t(16u), std::size_t(32u) }) {
+        std::array<char*, blocks_count> out {};
+        check(a.allocate_n(nT, out.size(), out.data()) == out.size(),
+              "a block of the batch was not given back");
+        a.deallocate_n(out.data(), out.size(), nT);
+    }
+}
+
+} // namespace
+
+auto main () -> int {
+    mixed_batch<virtual_allocator>();
+    check_free<virtual_allocator>();
+    mixed_batch<direct_allocator>();
+    check_free<direct_allocator>();
+    std::puts("beefy hardened: ok");
+    return 0;
+}
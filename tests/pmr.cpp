@@ -0,0 +1,107 @@
+/** @file pmr.cpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  Over-aligned requests to beefy::memory_resource with no upstream.
+ *
+ *         Storages of 24, 32 and 64 bytes, 8 blocks each, in 64-byte aligned
+ *         pools: one block of the 24-byte pool, every other block of the
+ *         32-byte one and all of the 64-byte one are 64-byte aligned, 13 in
+ *         total. That many 64-byte aligned requests must be served, all
+ *         aligned, the next one must go to the (null) upstream, and once they
+ *         are given back every block must be free again.
+ *
+ *         Failures abort.
+ */
+
+#include "allocators/beefy/pmr.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+using namespace kcppt;
+using namespace kcppt::allocators;
+
+constexpr auto blocks_count = std::size_t(8u);
+constexpr auto alignment = std::size_t(64u);
+constexpr auto aligned_count = std::size_t(1u + 4u + 8u);
+
+auto check (bool ok, const char* what) -> void {
+    if (!ok) {
+        std::fprintf(stderr, "pmr: %s\n", what);
+        std::abort();
+    }
+}
+
+beefy::bitmap_storage<char, 24, blocks_count> s24;
+beefy::bitmap_storage<char, 32, blocks_count> s32;
+beefy::storage<char, 64, blocks_count> s64;
+
+auto ptrs = beefy::make_ptrs_to_storages_array<char>(s24, s32, s64);
+
+using resource = beefy::memory_resource<char, decltype(ptrs), ptrs>;
+
+auto check_free () -> void {
+    for (auto s : ptrs) {
+        std::array<char*, blocks_count> out {};
+        check(s->allocate_blocks(out.data(), out.size()) == out.size(),
+              "a block was not given back");
+        s->deallocate_blocks(out.data(), out.size());
+    }
+}
+
+} // namespace
+
+auto main () -> int {
+    auto r = resource(std::pmr::null_memory_resource());
+    for (auto bytes : { std::size_t(8u), std::size_t(24u) }) {
+        std::array<void*, aligned_count> ps {};
+        for (auto& p : ps) {
+            p = r.allocate(bytes, alignment);
+            check(reinterpret_cast<std::uintptr_t>(p) % alignment == 0u,
+                  "a block is not aligned");
+        }
+        auto spilled = false;
+        try {
+            (void)r.allocate(bytes, alignment);
+        } catch (const std::bad_alloc&) {
+            spilled = true;
+        }
+        check(spilled, "more aligned blocks than the pools have");
+        for (auto p : ps) {
+            r.deallocate(p, bytes, alignment);
+        }
+        check_free();
+    }
+    std::puts("pmr: ok");
+    return 0;
+}
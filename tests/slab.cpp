@@ -0,0 +1,107 @@
+/** @file slab.cpp
+ *
+ * @author Novoselov Ivan
+ * @email  jedi.orden@gmail.com
+ * @date   16.10.2026
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 Ivan Novoselov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief  destroy() of pointers that are not objects of the slab cache.
+ *
+ *         Two caches share one backing storage, which also hands out a raw
+ *         block to somebody else. Objects of the other cache, objects of
+ *         a slab that was already reaped and pointers into the raw block
+ *         must all be ignored, neither cache may change its counts.
+ *
+ *         Failures abort.
+ */
+
+#include "allocators/slab.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using namespace kcppt;
+using namespace kcppt::allocators;
+
+struct object {
+    int value;
+};
+
+auto check (bool ok, const char* what) -> void {
+    if (!ok) {
+        std::fprintf(stderr, "slab: %s\n", what);
+        std::abort();
+    }
+}
+
+beefy::storage<std::byte, 512, 4> backing;
+
+} // namespace
+
+auto main () -> int {
+    auto a = slab::cache<object, 8, backing>();
+    auto b = slab::cache<object, 8, backing>();
+    
+    /// an object of the other cache
+    auto pa = a.make();
+    check(pa != nullptr, "no object");
+    b.destroy(pa);
+    check(a.objects_in_use() == 1u, "the other cache freed an object");
+    check(b.objects_in_use() == 0u, "an object of another cache counted");
+    
+    /// an object of a slab that was given back to the storage...
+    auto pb = b.make();
+    check(pb != nullptr, "no object");
+    b.destroy(pb);
+    check(b.reap() == 1u, "the empty slab is not released");
+    b.destroy(pb);
+    check(b.objects_in_use() == 0u, "an object of a released slab counted");
+    
+    /// ...and then taken by the other cache
+    auto more = a.make();
+    check(more != nullptr, "no object");
+    b.destroy(pb);
+    b.destroy(more);
+    check(a.objects_in_use() == 2u, "the other cache freed an object");
+    check(b.objects_in_use() == 0u, "an object of another cache counted");
+    
+    /// a block that is not a slab at all, its bytes look like one in use
+    auto raw = backing.allocate_block();
+    check(raw != nullptr, "no raw block");
+    std::memset(raw, 0xFF, 512u);
+    for (auto offset : { std::size_t(0u), std::size_t(128u) }) {
+        a.destroy(reinterpret_cast<object*>(raw + offset));
+    }
+    check(a.objects_in_use() == 2u, "a block that is not a slab counted");
+    backing.deallocate_block(raw);
+    
+    a.destroy(pa);
+    a.destroy(more);
+    check(a.objects_in_use() == 0u, "an object of the cache is not freed");
+    std::puts("slab: ok");
+    return 0;
+}
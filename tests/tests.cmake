@@ -0,0 +1,60 @@
+# @file tests/tests.cmake
+#  
+# @author Novoselov Ivan
+# @email  jedi.orden@gmail.com
+# @date   16.10.2026
+#
+# MIT License
+#
+# Copyright (c) 2019 Ivan Novoselov
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# @brief Functional tests, included by the top-level CMakeLists.txt when
+# configured with -Dtesting=ON. Every test is a plain executable that aborts
+# on the first failed check, ctest runs them all.
+
+enable_testing()
+
+find_package(Threads REQUIRED)
+
+# kcppt_add_test(<name> [<definitions>...]) builds tests/<name>.cpp,
+# the definitions are set for the whole executable, e.g. a hardened build
+function(kcppt_add_test name)
+    add_executable(test-${name} ${CMAKE_CURRENT_LIST_DIR}/${name}.cpp)
+    # the headers are used directly, the package target drags its
+    # vendor dependencies along
+    target_include_directories(
+        test-${name}
+        PRIVATE
+        ${CMAKE_CURRENT_LIST_DIR}/../install/headers
+    )
+    target_compile_definitions(test-${name} PRIVATE ${ARGN})
+    target_compile_options(
+        test-${name}
+        PRIVATE
+        $<$<CXX_COMPILER_ID:GNU,Clang>:-Wall -Wextra>
+    )
+    target_link_libraries(test-${name} PRIVATE Threads::Threads)
+    add_test(NAME ${name} COMMAND test-${name})
+endfunction()
+
+kcppt_add_test(beefy_hardened KCPPT_BEEFY_HARDENED)
+kcppt_add_test(pmr)
+kcppt_add_test(slab)